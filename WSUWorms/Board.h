@@ -0,0 +1,125 @@
+#ifndef BOARD_H // Guard
+#define BOARD_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include "Snapshot.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// Board encapsulates a 2D matrix of elements with a width and height
+/// determined at run time. Elements are stored contiguously in
+/// row-major order i.e. the element at {x, y} is immediately followed
+/// in memory by the element at {x+1, y}. Exactly width * height
+/// elements are allocated.
+///
+/// Design Notes:
+/// - Board is a class template so that the same storage and
+/// indexing logic can be reused for any type of element stored per
+/// board position e.g. squares displayed to users or bookkeeping
+/// information needed only by the simulation.
+/// - Row-major contiguous storage means that scanning a board one row
+/// at a time, as displays typically do, touches memory sequentially.
+///
+//////////////////////////////////////////////////////////////////////
+template <typename T>
+class Board
+{
+private:
+    int m_width;              //< Number of columns
+    int m_height;             //< Number of rows
+    std::vector<T> m_elements; //< width * height elements in row-major order
+
+    /// Returns the offset of the element at {x, y} in m_elements
+    std::size_t offsetOf(int x, int y) const
+    {
+        assert(x >= 0 && x < m_width);
+        assert(y >= 0 && y < m_height);
+        return (std::size_t)y * (std::size_t)m_width + (std::size_t)x;
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs an empty board with no elements.
+    Board() : m_width(0), m_height(0) {}
+
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a board with width columns and height rows in which
+    /// every element is a copy of initialValue.
+    Board(
+        int width,  //< The number of columns (must be >= 0)
+        int height, //< The number of rows (must be >= 0)
+        const T &initialValue = T()) : //< Value copied into every element
+        m_width(width), m_height(height),
+        m_elements((std::size_t)width * (std::size_t)height, initialValue)
+    {
+        assert(0 <= width && 0 <= height);
+    }
+
+    /// @name Non-mutating Accessors
+    /// @{
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    std::size_t size() const { return m_elements.size(); }
+    const T &at(int x, int y) const { return m_elements[offsetOf(x, y)]; }
+    const T *data() const { return m_elements.data(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the dimensions and elements of the board to out.
+    /// Elements must be trivially copyable.
+    void writeTo(Snapshot::writer &out) const
+    {
+        out.write((std::int32_t)m_width);
+        out.write((std::int32_t)m_height);
+        out.writeVector(m_elements);
+    }
+    /// @}
+
+    /// @name Mutating Accessors
+    /// @{
+    T &at(int x, int y) { return m_elements[offsetOf(x, y)]; }
+    T *data() { return m_elements.data(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets every element to a copy of value without changing the
+    /// dimensions of the board.
+    void fill(const T &value)
+    {
+        std::fill(m_elements.begin(), m_elements.end(), value);
+    }
+
+    //////////////////////////////////////////////////////////////////
+    /// Replaces the board with one read from in that was written by
+    /// writeTo(). Returns false, fails in, and leaves the board
+    /// unchanged if the board read does not have exactly width
+    /// columns and height rows.
+    bool readFrom(
+        Snapshot::reader &in,
+        int width,  //< The expected number of columns
+        int height) //< The expected number of rows
+    {
+        const std::size_t numElements = (std::size_t)width * (std::size_t)height;
+        std::int32_t fileWidth = 0;
+        std::int32_t fileHeight = 0;
+        std::vector<T> elements;
+        if(!in.read(fileWidth) || !in.read(fileHeight) ||
+            width != fileWidth || height != fileHeight ||
+            !in.readVector(elements, numElements) ||
+            elements.size() != numElements)
+        {   // !!!! EARLY EXIT !!!!
+            in.fail();
+            return false;
+        }
+        
+        m_width = width;
+        m_height = height;
+        m_elements.swap(elements);
+        return true;
+    }
+    /// @}
+};
+
+#endif // BOARD_H
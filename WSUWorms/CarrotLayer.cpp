@@ -0,0 +1,177 @@
+#include "CarrotLayer.h"
+#include <algorithm>
+#include <bitset>
+#include <utility>
+
+const std::uint32_t CarrotLayer::certainRegrowthChance; //< See documentation in header
+const int CarrotLayer::bitsPerWord; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+CarrotLayer::CarrotLayer(int width, int height) :
+    m_width(width),
+    m_height(height),
+    m_wordsPerRow((width + bitsPerWord - 1) / bitsPerWord)
+{
+    assert(0 <= width && 0 <= height);
+
+    m_carrots.assign((std::size_t)m_wordsPerRow * height, 0);
+    m_fertile.resize(m_carrots.size());
+    for(std::size_t i = 0; i < m_fertile.size(); ++i)
+    {
+        m_fertile[i] = wordOfRowBits((int)(i % m_wordsPerRow));
+    }
+}
+
+// See documentation in header
+void CarrotLayer::plantEverywhere()
+{
+    for(std::size_t i = 0; i < m_carrots.size(); ++i)
+    {
+        m_carrots[i] = wordOfRowBits((int)(i % m_wordsPerRow));
+    }
+    m_fertile = m_carrots;
+}
+
+// See documentation in header
+long CarrotLayer::getCount() const
+{
+    long result = 0;
+    for(word w : m_carrots)
+    {
+        result += countBits(w);
+    }
+    return result;
+}
+
+// See documentation in header
+void CarrotLayer::regrow(
+    std::uint32_t chance,
+    PseudoRandomGenerator &random,
+    PositionSet &out_planted)
+{
+    assert(chance <= certainRegrowthChance);
+
+    if(0 == chance)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    // A word in which each bit is set with probability
+    // chance / certainRegrowthChance is built by starting from all 0
+    // bits and, for each bit of chance from least to most significant,
+    // combining the word with a random word using OR if the bit of
+    // chance is 1 (which halves the probability of a 0) and using AND
+    // otherwise (which halves the probability of a 1). Bits of chance
+    // below the lowest 1 bit would only AND 0 with random words, so
+    // they are skipped.
+    const bool isCertain = (certainRegrowthChance == chance);
+    int firstChanceBit = 0;
+    while(!isCertain && 0 == (chance & ((std::uint32_t)1 << firstChanceBit)))
+    {
+        ++firstChanceBit;
+    }
+
+    for(int y = 0; y < m_height; ++y)
+    {
+        for(int k = 0; k < m_wordsPerRow; ++k)
+        {
+            const std::size_t i = (std::size_t)y * m_wordsPerRow + k;
+            const word room = m_fertile[i] & ~m_carrots[i];
+            if(0 == room)
+            {
+                continue;
+            }
+
+            word mask = isCertain ? ~(word)0 : 0;
+            for(int bit = firstChanceBit;
+                !isCertain && ((std::uint32_t)1 << bit) < certainRegrowthChance; ++bit)
+            {
+                const word r = random.next();
+                mask = (0 != (chance & ((std::uint32_t)1 << bit))) ?
+                    (mask | r) : (mask & r);
+            }
+
+            word planted = room & mask;
+            m_carrots[i] |= planted;
+            while(0 != planted)
+            {
+                const word lowest = planted & (~planted + 1);
+                out_planted.insert(k * bitsPerWord + countBits(lowest - 1), y);
+                planted ^= lowest;
+            }
+        }
+    }
+}
+
+
+// See documentation in header
+void CarrotLayer::writeTo(Snapshot::writer &out) const
+{
+    out.write((std::int32_t)m_width);
+    out.write((std::int32_t)m_height);
+    out.writeVector(m_carrots);
+    out.writeVector(m_fertile);
+}
+
+// See documentation in header
+bool CarrotLayer::readFrom(Snapshot::reader &in, int width, int height)
+{
+    CarrotLayer result(width, height);
+    std::int32_t fileWidth = 0;
+    std::int32_t fileHeight = 0;
+    in.read(fileWidth);
+    in.read(fileHeight);
+    in.readVector(result.m_carrots, result.m_fertile.size());
+    in.readVector(result.m_fertile, result.m_fertile.size());
+    bool isValid = in.isValid() && width == fileWidth &&
+        height == fileHeight &&
+        result.m_carrots.size() == result.m_fertile.size();
+
+    // Bits beyond the end of each row are always 0, and carrots only
+    // grow in fertile squares
+    for(std::size_t i = 0; isValid && i < result.m_fertile.size(); ++i)
+    {
+        const word rowBits = result.wordOfRowBits(
+            (int)(i % result.m_wordsPerRow));
+        isValid = 0 == (result.m_fertile[i] & ~rowBits) &&
+            0 == (result.m_carrots[i] & ~result.m_fertile[i]);
+    }
+    if(!isValid)
+    {   // !!!! EARLY EXIT !!!!
+        in.fail();
+        return false;
+    }
+
+    *this = std::move(result);
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the number of 1 bits in w. std::bitset::count() compiles
+/// to a single population count instruction where one exists.
+int CarrotLayer::countBits(word w)
+{
+    return (int)std::bitset<bitsPerWord>(w).count();
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Returns a word with a 1 bit for each column of a row that is stored
+/// in the word at index wordInRow within the row.
+CarrotLayer::word CarrotLayer::wordOfRowBits(int wordInRow) const
+{
+    assert(0 <= wordInRow && wordInRow < m_wordsPerRow);
+
+    const int numColumns = std::min(bitsPerWord,
+        m_width - wordInRow * bitsPerWord);
+    return (bitsPerWord == numColumns) ? ~(word)0 :
+        (((word)1 << numColumns) - 1);
+}
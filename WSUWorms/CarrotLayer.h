@@ -0,0 +1,134 @@
+#ifndef CARROTLAYER_H // Guard
+#define CARROTLAYER_H
+
+#include <cstdint>
+#include <vector>
+#include <cassert>
+#include "PseudoRandomGenerator.h"
+#include "PositionSet.h"
+#include "Snapshot.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// CarrotLayer records which squares of a board contain carrots using
+/// one bit per square, and which squares are "fertile" i.e. squares
+/// in which carrots may grow again after being eaten.
+///
+/// Design Notes:
+/// - Bits are stored in 64 bit words in row-major order. Every row
+/// starts with a new word, and unused bits at the end of each row
+/// are always 0. Because no word contains squares from two rows,
+/// threads may eat carrots concurrently in disjoint sets of rows.
+/// - Whole-layer operations such as counting carrots and regrowing
+/// carrots process 64 squares per word operation.
+///
+//////////////////////////////////////////////////////////////////////
+class CarrotLayer
+{
+public:
+    /// The type of the words that store bits
+    typedef std::uint64_t word;
+
+    /// Regrowth chances are fractions of this value
+    static const std::uint32_t certainRegrowthChance = 1 << 16;
+
+private:
+    /// The number of bits in a word
+    static const int bitsPerWord = 64;
+
+    int m_width;         //< Number of columns
+    int m_height;        //< Number of rows
+    int m_wordsPerRow;   //< Number of words storing each row
+
+    /// Bit x % bitsPerWord of word y * m_wordsPerRow + x / bitsPerWord
+    /// is set iff the square at {x,y} contains a carrot
+    std::vector<word> m_carrots;
+
+    /// Bits are set for squares in which carrots may regrow. Uses the
+    /// same layout as m_carrots.
+    std::vector<word> m_fertile;
+
+    /// Returns the index of the word that stores the square at {x,y}
+    std::size_t wordIndexOf(int x, int y) const {
+        assert(0 <= x && x < m_width && 0 <= y && y < m_height);
+        return (std::size_t)y * m_wordsPerRow + x / bitsPerWord; }
+
+    /// Returns the bit of its word that stores column x
+    static word bitOf(int x) { return (word)1 << (x % bitsPerWord); }
+
+    // See documentation in implementation file
+    static int countBits(word w);
+
+    // See documentation in implementation file
+    word wordOfRowBits(int wordInRow) const;
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a layer for a board with width columns and height
+    /// rows that contains no carrots and in which every square is
+    /// fertile.
+    CarrotLayer(
+        int width = 0, //< The number of columns in the board
+        int height = 0 //< The number of rows in the board
+    );
+
+    //////////////////////////////////////////////////////////////////
+    /// Places a carrot in every square and makes every square fertile.
+    void plantEverywhere();
+
+    /// Returns true iff the square at {x,y} contains a carrot
+    bool contains(int x, int y) const {
+        return 0 != (m_carrots[wordIndexOf(x, y)] & bitOf(x)); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Removes the carrot from the square at {x,y}. Returns true if
+    /// the square contained a carrot and false otherwise.
+    bool tryToEat(int x, int y) {
+        word &w(m_carrots[wordIndexOf(x, y)]);
+        const word bit = bitOf(x);
+        const bool result = 0 != (w & bit);
+        w &= ~bit;
+        return result; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Removes any carrot from the square at {x,y} and prevents
+    /// carrots from growing there until plantEverywhere() is called.
+    void makeBarren(int x, int y) {
+        const std::size_t i = wordIndexOf(x, y);
+        m_carrots[i] &= ~bitOf(x);
+        m_fertile[i] &= ~bitOf(x); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of squares that contain carrots. The time
+    /// taken is proportional to the number of words, not squares.
+    long getCount() const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the dimensions, carrots, and fertile squares of the
+    /// layer to out.
+    void writeTo(Snapshot::writer &out) const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Replaces the layer with one read from in that was written by
+    /// writeTo(). Returns false, fails in, and leaves the layer
+    /// unchanged if the layer read does not have exactly width
+    /// columns and height rows or records carrots outside of the
+    /// board or in barren squares.
+    bool readFrom(
+        Snapshot::reader &in,
+        int width,  //< The expected number of columns
+        int height); //< The expected number of rows
+
+    //////////////////////////////////////////////////////////////////
+    /// Places a carrot in each fertile square without a carrot with
+    /// probability chance / certainRegrowthChance and inserts the
+    /// position of every placed carrot into out_planted. Consumes
+    /// pseudo random numbers from random only for words that contain
+    /// at least one fertile square without a carrot.
+    void regrow(
+        std::uint32_t chance, //< 0..certainRegrowthChance
+        PseudoRandomGenerator &random,
+        PositionSet &out_planted);
+};
+
+#endif // CARROTLAYER_H
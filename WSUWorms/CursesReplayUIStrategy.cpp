@@ -0,0 +1,300 @@
+#include "CursesReplayUIStrategy.h"
+#include "CursesWormsSimUIStrategy.h"
+#include <ncurses.h>
+#include <algorithm>
+#include <cstring>
+
+const double CursesReplayUIStrategy::minFramesPerSecond = 1.0; //< See documentation in header
+const double CursesReplayUIStrategy::maxLimitedFramesPerSecond = 1600.0; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+//!!!!! NOTE: Pre and post conditions are not provided here due to
+// instructor guidance not to provide pre and post conditions related
+// to Curses based display.
+
+// See documentation in header
+CursesReplayUIStrategy::CursesReplayUIStrategy(Recording::player &player) :
+    m_player(player),
+    m_scheduler(100.0, 30.0),
+    m_visibleWidth(0),
+    m_visibleHeight(0),
+    m_isPaused(false),
+    m_isReversed(false),
+    m_isFullRedrawNeeded(true),
+    m_isFrameDrawn(false)
+{
+}
+
+// See documentation in header
+void CursesReplayUIStrategy::run()
+{
+    updateVisibleSize();
+    m_player.seekToFrame(0);
+    m_scheduler.restart();
+
+    for(bool shouldEnd = false; !shouldEnd; )
+    {
+        redrawDisplay();
+        shouldEnd = processUserInput();
+        if(!m_isPaused)
+        {
+            playOneFrame();
+        }
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Makes the next frame in the direction of play current or pauses
+/// if there is no such frame.
+void CursesReplayUIStrategy::playOneFrame()
+{
+    const bool hasPlayed = m_isReversed ?
+        m_player.previousFrame() : m_player.nextFrame();
+    if(!hasPlayed)
+    {
+        m_isPaused = true;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Draws a frame unless the previous frame was drawn too recently for
+/// the maximum frame rate, in which case changes accumulate until the
+/// next frame.
+void CursesReplayUIStrategy::redrawDisplay()
+{
+    m_isFrameDrawn = m_isFullRedrawNeeded || m_scheduler.isFrameDue();
+    if(m_isFrameDrawn)
+    {
+        drawFrame();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Draws the squares of the current frame that changed since the last
+/// frame was drawn, or every square if a full redraw is needed, and
+/// the status.
+void CursesReplayUIStrategy::drawFrame()
+{
+    const PositionSet &changed(m_player.getChangedSquares());
+
+    if(m_isFullRedrawNeeded || changed.containsEverything())
+    {
+        if(m_isFullRedrawNeeded)
+        {
+            clear(); // Discard whatever the display shows now
+        }
+        for(int y = 0; y < m_visibleHeight; ++y)
+        {
+            move(y, 0);
+            for(int x = 0; x < m_visibleWidth; ++x)
+            {
+                addch((unsigned char)m_player.getOnecAt(x, y) |
+                    CursesWormsSimUIStrategy::getDisplayAttr(
+                        m_player.getAttrAt(x, y)));
+            }
+        }
+        m_isFullRedrawNeeded = false;
+    }
+    else
+    {
+        for(const PositionSet::position &p : changed.getPositions())
+        {
+            if(p.x < m_visibleWidth && p.y < m_visibleHeight)
+            {
+                mvaddch(p.y, p.x, (unsigned char)m_player.getOnecAt(p.x, p.y) |
+                    CursesWormsSimUIStrategy::getDisplayAttr(
+                        m_player.getAttrAt(p.x, p.y)));
+            }
+        }
+    }
+
+    m_player.clearChangedSquares();
+    showStatus(); // refreshes the display
+    m_scheduler.onFrameDrawn();
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Waits for user input until the next frame is due to be played or
+/// indefinitely while paused and handles any input. The display is
+/// drawn after each key so that the effect of keys that move through
+/// the recording while paused is visible. Returns true iff the user
+/// pressed ESC.
+bool CursesReplayUIStrategy::processUserInput()
+{
+    m_scheduler.onStepFinished();
+
+    if(!m_isFrameDrawn && m_scheduler.isUnlimited() && !m_isPaused)
+    {   // !!!! NOTE EARLY RETURN !!!! Checking for input after every
+        // frame would limit the rate of frames.
+        return false;
+    }
+
+    for(;;)
+    {
+        timeout(m_isPaused ? -1 : m_scheduler.getMillisecondsUntilNextStep());
+        int key = getch();
+        if (key == ERR)
+        {
+            break;  // The next frame is due
+        }
+        if (key == KEY_RESIZE)
+        {
+            updateVisibleSize();
+        }
+        if (key == esc)
+        {    // !!!! NOTE EARLY RETURN !!!!
+             nodelay(stdscr, TRUE);
+             return true;
+        }
+        handleUserKeyPress(key);
+        drawFrame();
+    }
+    nodelay(stdscr, TRUE);
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Perform replay specific logic in response to user input of the
+/// character, c.
+void CursesReplayUIStrategy::handleUserKeyPress(int c)
+{
+    const long numFrames = m_player.getNumFrames();
+
+    switch (c) {
+        case '+':
+        {
+            if(!m_scheduler.isUnlimited())
+            {
+                m_scheduler.setTargetStepsPerSecond(
+                    2.0 * m_scheduler.getTargetStepsPerSecond());
+            }
+            break;
+        }
+        case '-':
+        {
+            m_scheduler.setTargetStepsPerSecond(m_scheduler.isUnlimited() ?
+                maxLimitedFramesPerSecond :
+                std::max(minFramesPerSecond,
+                    0.5 * m_scheduler.getTargetStepsPerSecond()));
+            break;
+        }
+        case 'f':
+        {
+            // Fast-forward (or fast-reverse) at maximum speed
+            m_scheduler.setTargetStepsPerSecond(0.0);
+            break;
+        }
+        case 'r':
+        {
+            m_isReversed = !m_isReversed;
+            break;
+        }
+        case '.':
+        {
+            m_isPaused = true;
+            m_player.nextFrame();
+            break;
+        }
+        case ',':
+        {
+            m_isPaused = true;
+            m_player.previousFrame();
+            break;
+        }
+        case ']':
+        {
+            m_player.seekToFrame(std::min(numFrames - 1,
+                m_player.getFrameNumber() + m_player.getKeyframeInterval()));
+            break;
+        }
+        case '[':
+        {
+            m_player.seekToFrame(std::max(0L,
+                m_player.getFrameNumber() - m_player.getKeyframeInterval()));
+            break;
+        }
+        case ' ':
+        {
+            m_isPaused = !m_isPaused;
+            m_scheduler.restart(); // Do not catch up after pausing
+            break;
+        }
+        default:
+        {
+            if('0' <= c && c <= '9')
+            {
+                // Digits jump to tenths of the recording
+                m_player.seekToFrame((c - '0') * numFrames / 10);
+            }
+            break;
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Computes how much of the recorded board fits in the display above
+/// the message area and requests a full redraw.
+void CursesReplayUIStrategy::updateVisibleSize()
+{
+    int rows = 0;
+    int cols = 0;
+    getmaxyx(stdscr, rows, cols);
+    m_visibleWidth = std::max(0, std::min(m_player.getWidth(), cols));
+    m_visibleHeight = std::max(0,
+        std::min(m_player.getHeight(), rows - rowsInMessageArea));
+    m_isFullRedrawNeeded = true;
+}
+
+// See documentation in header
+void CursesReplayUIStrategy::showStatus()
+{
+    static const size_t maxMessageLen = 1000;  //< Arbitrary large
+    static const size_t maxRateLen = 16;       //< Arbitrary
+
+    char targetRate[maxRateLen] = "unlimited";
+    if(!m_scheduler.isUnlimited())
+    {
+        snprintf(targetRate, maxRateLen, "%.0f",
+            m_scheduler.getTargetStepsPerSecond());
+    }
+
+    char msg[maxMessageLen];
+    snprintf
+    (msg, maxMessageLen,
+         "REPLAY: SPC %s, ESC terminates, r reverses, . and , step, "
+         "[ and ] jump %d frames, 0-9 seek\n"
+         "frame %ld of %ld, step %lld, %s\n"
+         "%s frames/sec, - slower, + faster, f full-speed\n"
+         "living worms of each type:",
+         (m_isPaused ? "resumes" : "pauses"),
+         m_player.getKeyframeInterval(),
+         m_player.getFrameNumber() + 1,
+         m_player.getNumFrames(),
+         (long long)m_player.getStep(),
+         (m_isPaused ? "paused" :
+            (m_isReversed ? "playing backward" : "playing forward")),
+         targetRate);
+
+    for(int i = 0; i < m_player.getNumPopulationCounts(); ++i)
+    {
+        const size_t len = strlen(msg);
+        snprintf(msg + len, maxMessageLen - len, " %d",
+            m_player.getPopulationCount(i));
+    }
+    const size_t len = strlen(msg);
+    snprintf(msg + len, maxMessageLen - len, "\n\n\n");
+
+    move(m_visibleHeight + 1, 0);
+    clrtobot();
+    addstr(msg);
+    refresh();
+}
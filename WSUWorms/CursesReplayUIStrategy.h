@@ -0,0 +1,93 @@
+#ifndef CURSESREPLAYUISTRATEGY_H // Guard
+#define CURSESREPLAYUISTRATEGY_H
+
+#include "Recording.h"
+#include "FixedTimestepScheduler.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// Instances of CursesReplayUIStrategy play a recorded simulation run
+/// in an NCurses display without simulating it again. The recording
+/// plays forward or backward at a selectable rate, may be paused and
+/// stepped one frame at a time, and may jump to any frame.
+///
+/// Design Notes:
+/// - Unlike CursesWormsSimUIStrategy, this strategy is not called by
+/// a running WormsSim: it runs its own loop and reads every frame
+/// from a Recording::player. Frames are drawn the same way, using
+/// the same display attributes, so a replay looks like the run that
+/// was recorded.
+/// - A FixedTimestepScheduler decides when frames of the recording
+/// are played and when the display is drawn, so playing at a high
+/// rate does not draw every frame.
+/// - Playing backward costs about twice as much as playing forward.
+/// See Recording.
+///
+//////////////////////////////////////////////////////////////////////
+class CursesReplayUIStrategy
+{
+private:
+    static const char esc = '\033'; //< the ESC char ASCII code
+    static const int rowsInMessageArea = 9; //< As in CursesWormsSimUIStrategy
+    static const double minFramesPerSecond;  //< Slowest rate '-' selects
+    static const double maxLimitedFramesPerSecond; //< Rate '-' selects after 'f'
+
+    /// The recording being played
+    Recording::player &m_player;
+
+    /// Decides when frames are played and when the display is drawn
+    FixedTimestepScheduler m_scheduler;
+
+    /// The number of columns and rows of the recorded board that fit
+    /// in the display
+    int m_visibleWidth;
+    int m_visibleHeight;
+
+    bool m_isPaused;            //< == true iff frames are not played
+    bool m_isReversed;          //< == true iff frames play backward
+    bool m_isFullRedrawNeeded;  //< See CursesWormsSimUIStrategy
+    bool m_isFrameDrawn;        //< == true iff the last redraw drew a frame
+
+    // See documentation in implementation file
+    void playOneFrame();
+
+    // See documentation in implementation file
+    void redrawDisplay();
+
+    // See documentation in implementation file
+    void drawFrame();
+
+    // See documentation in implementation file
+    bool processUserInput();
+
+    // See documentation in implementation file
+    void handleUserKeyPress(int c);
+
+    // See documentation in implementation file
+    void updateVisibleSize();
+
+    // Draw information about the position and rate of the replay
+    void showStatus();
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a strategy that plays player forward at 100 frames
+    /// per second from its first frame. The display must have been
+    /// initialized with CursesWormsSimUIStrategy::initializeForDisplay().
+    CursesReplayUIStrategy(
+        Recording::player &player); //< A valid recording
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the number of recorded frames played per second. Pass 0
+    /// to play frames as fast as possible.
+    void setTargetFramesPerSecond(
+        double framesPerSecond) { //< >= 0
+        m_scheduler.setTargetStepsPerSecond(framesPerSecond); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Plays the recording until the user presses ESC. Playing pauses
+    /// at either end of the recording.
+    void run();
+};
+
+#endif // CURSESREPLAYUISTRATEGY_H
@@ -1,7 +1,8 @@
 #include "CursesWormsSimUIStrategy.h"
 #include <ncurses.h>
-#include <unistd.h>   // For usleep()
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 
 //////////////////////////////////////////////////////////////////////
 //                          PUBLIC METHODS
@@ -28,29 +29,37 @@ bool CursesWormsSimUIStrategy::confirmExit()
 // See documentation in header
 bool CursesWormsSimUIStrategy::processUserInput()
 {
-    static const int numMicrosecondsInAMillisecond = 1000;
+    m_scheduler.onStepFinished();
     
-    showStatus();
+    if(!m_isFrameDrawn && m_scheduler.isUnlimited() && !isPaused)
+    {   // !!!! NOTE EARLY RETURN !!!! Checking for input after every
+        // step would limit the rate of steps.
+        return false;
+    }
     
-    for (delayRemaining = slowness+1;
-        delayRemaining > 0;
-        delayRemaining -= delayQuantum)
+    for(;;)
     {
-        char c = handleUserKeyPress(getch()); // no-delay
-        if (c == esc)
-        {    // !!!! NOTE EARLY RETURN !!!!
-             return true;
-        }
-        if (isPaused)
+        // Wait for input until the next step is due or indefinitely
+        // while paused
+        timeout(isPaused ? -1 : m_scheduler.getMillisecondsUntilNextStep());
+        int key = getch();
+        if (key == ERR)
         {
-            delayRemaining += delayQuantum;
-            showStatus();
+            break;  // The next step is due
         }
-        if (delayQuantum > 0)
+        if (key == KEY_RESIZE)
         {
-            usleep(numMicrosecondsInAMillisecond * delayQuantum);
+            requestFullRedraw();
+        }
+        char c = handleUserKeyPress(key);
+        if (c == esc)
+        {    // !!!! NOTE EARLY RETURN !!!!
+             nodelay(stdscr, TRUE);
+             return true;
         }
+        showStatus();
     }
+    nodelay(stdscr, TRUE);
     
     return false;
 }
@@ -66,17 +75,46 @@ void CursesWormsSimUIStrategy::showMessage(std::string text, int y)
 // See documentation in header
 void CursesWormsSimUIStrategy::redrawDisplay()
 {
-    for(int y = 0; y < m_sim.getHeight(); ++y)
+    m_isFrameDrawn = m_isFullRedrawNeeded || m_scheduler.isFrameDue();
+    if(!m_isFrameDrawn)
+    {   // !!!! NOTE EARLY RETURN !!!! Changes accumulate until the
+        // next frame
+        return;
+    }
+    
+    const PositionSet &changed(m_sim.getChangedSquares());
+    
+    if(m_isFullRedrawNeeded || changed.containsEverything())
     {
-        move(y, 0);
-        for(int x = 0; x < m_sim.getWidth(); ++x)
+        if(m_isFullRedrawNeeded)
+        {
+            clear(); // Discard whatever the display shows now
+        }
+        for(int y = 0; y < m_sim.getHeight(); ++y)
         {
-            char onec = m_sim.getOnecAt(x, y);
-            int attr = m_sim.getAttrAt(x, y);
-            addch(onec | wormAttr[attr]);
+            move(y, 0);
+            for(int x = 0; x < m_sim.getWidth(); ++x)
+            {
+                char onec = m_sim.getOnecAt(x, y);
+                int attr = m_sim.getAttrAt(x, y);
+                addch(onec | getDisplayAttr(attr));
+            }
         }
+        m_isFullRedrawNeeded = false;
     }
-    refresh();
+    else
+    {
+        for(const PositionSet::position &p : changed.getPositions())
+        {
+            drawSquareAt(p.x, p.y);
+        }
+    }
+    
+    drawHighlightedWorm();
+    
+    m_sim.clearChangedSquares();
+    showStatus(); // refreshes the display
+    m_scheduler.onFrameDrawn();
 }
 
 // See documentation in header
@@ -101,9 +139,6 @@ void CursesWormsSimUIStrategy::releaseDisplay()
 //////////////////////////////////////////////////////////////////////
 
 //////////////////////////////////////////////////////////////////////
-int CursesWormsSimUIStrategy::slowness = 10;     //< See documentation in header
-int CursesWormsSimUIStrategy::delayQuantum = 10; //< See documentation in header
-int CursesWormsSimUIStrategy::delayRemaining;    //< See documentation in header
 bool CursesWormsSimUIStrategy::isPaused(false); //< See documentation in header
 
 //////////////////////////////////////////////////////////////////////
@@ -132,6 +167,42 @@ void CursesWormsSimUIStrategy::startCurses(int &asogRows, int &asogCols)
     getmaxyx(stdscr, asogRows, asogCols);
 }
 
+//////////////////////////////////////////////////////////////////////
+/// Draws the simulation's square at {x, y} at the corresponding
+/// display position combining the square's display attributes with
+/// extraAttr.
+void CursesWormsSimUIStrategy::drawSquareAt(int x, int y, int extraAttr)
+{
+    char onec = m_sim.getOnecAt(x, y);
+    int attr = m_sim.getAttrAt(x, y);
+    mvaddch(y, x, onec | getDisplayAttr(attr) | extraAttr);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Restores the normal appearance of squares highlighted by the
+/// previous call and then draws the squares covered by the
+/// highlighted worm, if it is still alive, with a distinctive display
+/// attribute.
+void CursesWormsSimUIStrategy::drawHighlightedWorm()
+{
+    for(const PositionSet::position &p : m_highlightedSquares)
+    {
+        drawSquareAt(p.x, p.y);
+    }
+    m_highlightedSquares.clear();
+    
+    if(m_sim.isLivingWorm(m_highlightedWorm))
+    {
+        const Worm worm(m_sim.getWorm(m_highlightedWorm.index));
+        for(const Worm::segment &s : worm.getBody())
+        {
+            drawSquareAt(s.getX(), s.getY(), A_BOLD | A_UNDERLINE);
+            PositionSet::position p = {s.getX(), s.getY()};
+            m_highlightedSquares.push_back(p);
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////
 /// Returns one available character of user input. This function
 /// blocks until at least one character is available.
@@ -146,25 +217,188 @@ int CursesWormsSimUIStrategy::getOneChar()
 // See documentation in header
 void CursesWormsSimUIStrategy::showStatus()
 {
-    static const size_t maxMessageLen = 1000;  //< Arbitrary large
+    static const size_t maxMessageLen = 2000;  //< Arbitrary large
+    static const size_t maxRateLen = 16;       //< Arbitrary
+    
+    char targetRate[maxRateLen] = "unlimited";
+    if(!m_scheduler.isUnlimited())
+    {
+        snprintf(targetRate, maxRateLen, "%.0f",
+            m_scheduler.getTargetStepsPerSecond());
+    }
+    
+    // The population of each species is shown on one row in the
+    // order of the simulation's species as far as the row fits
+    const SpeciesRegistry &species(m_sim.getSpecies());
+    const size_t rowLen = (size_t)std::min(m_sim.getWidth(), maxGraphRowLen);
+    char populations[maxGraphRowLen + 1] = "";
+    size_t populationsLen = 0;
+    for(int i = 0; i < species.size() && populationsLen < rowLen; ++i)
+    {
+        populationsLen += (size_t)snprintf(populations + populationsLen,
+            rowLen + 1 - populationsLen, "%2d %ss,",
+            m_sim.getPopulation().getCount(i), species[i].getName().c_str());
+    }
     
     char msg[maxMessageLen];
     snprintf
     (msg, maxMessageLen,
          "SPC %s, ESC terminates, k kills-, w creates-, s "
-         "shows-a-worm\n%2d Vegetarians,%2d Cannibals,%2d "
-         "Scissor-heads,%2d hi-water-mark\n"
-         "%04d slowness, - increases, + reduces, f full-speed\n\n\n",
+         "shows-a-worm\n%.*s%2d hi-water-mark\n"
+         "%s steps/sec, max %.0f frames/sec, - slower, + faster, f full-speed\n"
+         "%7ld carrots, %.4f%% regrowth per step, c changes regrowth\n",
          (isPaused ? "resumes " : "pauses "),
-         Worm::getNumVegetarians(),
-         Worm::getNumCanibals(),
-         Worm::getNumScissorheads(),
+         (int)std::min(populationsLen, rowLen), populations,
          m_sim.getHighWaterMark(),
-         getSlowness());
+         targetRate,
+         m_scheduler.getMaxFramesPerSecond(),
+         m_sim.getNumCarrots(),
+         100.0 * m_sim.getCarrotRegrowthRate());
+    
+    formatGraphs(msg + strlen(msg), maxMessageLen - strlen(msg));
+    
+    const StepProfiler &profiler(m_sim.getProfiler());
+    const StepProfiler::interval &last(profiler.getLastInterval());
+    const size_t len = strlen(msg);
+    if(!profiler.isEnabled())
+    {
+        snprintf(msg + len, maxMessageLen - len,
+            "p shows timing\n\n\n");
+    }
+    else if(0 == last.numSteps)
+    {
+        snprintf(msg + len, maxMessageLen - len,
+            "timing %d steps, p hides timing\n\n\n",
+            profiler.getStepsPerInterval());
+    }
+    else
+    {
+        const double steps = (double)last.numSteps;
+        snprintf(msg + len, maxMessageLen - len,
+            "ms/step: live %.3f, regrow %.3f, board %.3f, redraw %.3f, "
+            "input %.3f\n"
+            "%.1f steps/sec, %.1f victim lookups/step, %.1f carrots "
+            "eaten/step, p hides\n\n",
+            1000.0 * last.phaseSeconds[StepProfiler::LIVE] / steps,
+            1000.0 * last.phaseSeconds[StepProfiler::REGROW] / steps,
+            1000.0 * last.phaseSeconds[StepProfiler::UPDATE_BOARD] / steps,
+            1000.0 * last.phaseSeconds[StepProfiler::REDRAW] / steps,
+            1000.0 * last.phaseSeconds[StepProfiler::INPUT] / steps,
+            steps / std::max(last.seconds, 1e-9),
+            last.numVictimLookups / steps,
+            last.numCarrotsEaten / steps);
+    }
     
      showMessage(msg, m_sim.getHeight() + 1);
 }
 
+//////////////////////////////////////////////////////////////////////
+/// Writes a label, the most recent sample, and a sparkline of as many
+/// of the most recent samples as fit, width characters in all, to
+/// out. The sparkline's lowest and highest levels are the smallest
+/// and largest samples shown. out must have room for width + 1
+/// characters.
+void CursesWormsSimUIStrategy::formatSparkline(
+    const RingBuffer<long> &samples,
+    const char *label,
+    int width,
+    char *out)
+{
+    const int numLevels = (int)strlen(sparklineLevels);
+    
+    int len = snprintf(out, (size_t)width + 1, "%s %ld ", label,
+        samples.empty() ? 0L : samples.back());
+    len = std::min(std::max(len, 0), width);
+    
+    // Leave a blank after the sparkline to separate it from the next
+    const int numShown = std::min((int)samples.size(), width - len - 1);
+    const std::size_t first = samples.size() - std::max(numShown, 0);
+    long lowest = 0;
+    long highest = 0;
+    for(std::size_t i = first; i < samples.size(); ++i)
+    {
+        lowest = (i == first) ? samples[i] : std::min(lowest, samples[i]);
+        highest = (i == first) ? samples[i] : std::max(highest, samples[i]);
+    }
+    
+    for(std::size_t i = first; i < samples.size(); ++i)
+    {
+        const long range = highest - lowest;
+        out[len++] = sparklineLevels[(0 == range) ? 0 :
+            (int)((double)(samples[i] - lowest) * (numLevels - 1) / range + 0.5)];
+    }
+    while(len < width)
+    {
+        out[len++] = ' ';
+    }
+    out[len] = '\0';
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Writes two rows of sparklines showing the history of the sim's
+/// statistics to out, or a hint about showing them if the sim's
+/// statistics are disabled. Each row ends with a newline. The rows
+/// are no wider than the display.
+void CursesWormsSimUIStrategy::formatGraphs(char *out, std::size_t maxLen) const
+{
+    const StatisticsCollector &statistics(m_sim.getStatistics());
+    if(!statistics.isEnabled())
+    {   // !!!! EARLY EXIT !!!!
+        snprintf(out, maxLen, "g shows graphs\n\n");
+        return;
+    }
+    
+    static const char hint[] = "g hides";
+    static const StatisticsCollector::series totals[] = {
+        StatisticsCollector::BODY_LENGTH, StatisticsCollector::STOMACH,
+        StatisticsCollector::CARROTS, StatisticsCollector::BIRTHS,
+        StatisticsCollector::DEATHS};
+    static const char *totalLabels[] = {
+        "length", "food", "carrots", "born", "died"};
+    static const int numTotals = (int)(sizeof(totals) / sizeof(totals[0]));
+    
+    const int rowWidth = std::min(m_sim.getWidth(), maxGraphRowLen);
+    const int numPopulations = statistics.getNumPopulations();
+    const SpeciesRegistry &species(m_sim.getSpecies());
+    char row[maxGraphRowLen + 1];
+    
+    // The first row shows populations and the hint
+    int len = 0;
+    const int populationWidth = (rowWidth - (int)strlen(hint)) /
+        std::max(numPopulations, 1);
+    for(int i = 0; i < numPopulations && 0 < populationWidth; ++i)
+    {
+        // Each population is labeled by the first letters of its
+        // species' name e.g. "veg" for Vegetarians
+        char label[4] = "";
+        for(int j = 0; j < 3 && j < (int)species[i].getName().size(); ++j)
+        {
+            label[j] = (char)tolower(species[i].getName()[j]);
+            label[j + 1] = '\0';
+        }
+        formatSparkline(statistics.getPopulationSeries(i), label,
+            populationWidth, row + len);
+        len += populationWidth;
+    }
+    snprintf(row + len, sizeof(row) - len, "%s", hint);
+    size_t outLen = (size_t)snprintf(out, maxLen, "%s\n", row);
+    
+    // The second row shows totals
+    len = 0;
+    const int totalWidth = rowWidth / numTotals;
+    row[0] = '\0';
+    for(int i = 0; i < numTotals && 0 < totalWidth; ++i)
+    {
+        formatSparkline(statistics.getSeries(totals[i]), totalLabels[i],
+            totalWidth, row + len);
+        len += totalWidth;
+    }
+    if(outLen < maxLen)
+    {
+        snprintf(out + outLen, maxLen - outLen, "%s\n", row);
+    }
+}
+
 //////////////////////////////////////////////////////////////////////
 /// Perform user interface specific logic in response to user input
 /// of the character, c.
@@ -173,27 +407,36 @@ char CursesWormsSimUIStrategy::handleUserKeyPress(char c)
     switch (c) {
         case '+':
         {
-            slowness -= std::min(slowness, 100);   //< Arbitrary
+            if(!m_scheduler.isUnlimited())
+            {
+                m_scheduler.setTargetStepsPerSecond(
+                    2.0 * m_scheduler.getTargetStepsPerSecond());
+            }
             break;
         }
         case '-':
         {
-            slowness += 100;  //< Arbitrary
+            m_scheduler.setTargetStepsPerSecond(m_scheduler.isUnlimited() ?
+                maxLimitedStepsPerSecond :
+                std::max(minStepsPerSecond,
+                    0.5 * m_scheduler.getTargetStepsPerSecond()));
             break;
         }
         case 'f':
         {
-            slowness = 0; // Let simulation run at maximum speed
+            // Let simulation run at maximum speed
+            m_scheduler.setTargetStepsPerSecond(0.0);
             break;
         }
         case 's':
         {
-            /* TODO: highlight a worm */
+            m_highlightedWorm = m_sim.getNextLivingWorm(m_highlightedWorm);
+            drawHighlightedWorm();
             break;
         }
         case 'k':
         {
-            /* TODO: kill the highlighted worm */
+            m_sim.killWorm(m_highlightedWorm);
             break;
         }
         case 'w':
@@ -201,9 +444,35 @@ char CursesWormsSimUIStrategy::handleUserKeyPress(char c)
             m_sim.createWorm();
             break;
         }
+        case 'p':
+        {
+            StepProfiler &profiler(m_sim.getProfiler());
+            profiler.setEnabled(!profiler.isEnabled());
+            break;
+        }
+        case 'g':
+        {
+            StatisticsCollector &statistics(m_sim.getStatistics());
+            statistics.setEnabled(!statistics.isEnabled());
+            break;
+        }
+        case 'c':
+        {
+            // Select the next regrowth rate after the current one
+            std::size_t i = 0;
+            while(i < carrotRegrowthRates.size() &&
+                carrotRegrowthRates[i] <= m_sim.getCarrotRegrowthRate())
+            {
+                ++i;
+            }
+            m_sim.setCarrotRegrowthRate((i < carrotRegrowthRates.size()) ?
+                carrotRegrowthRates[i] : carrotRegrowthRates[0]);
+            break;
+        }
         case ' ':
         {
             isPaused ^= 1;
+            m_scheduler.restart(); // Do not catch up after pausing
             break;
         }
         default:
@@ -214,13 +483,32 @@ char CursesWormsSimUIStrategy::handleUserKeyPress(char c)
     return c;
 }
 
+const int CursesWormsSimUIStrategy::maxGraphRowLen; //< See documentation in header
+const double CursesWormsSimUIStrategy::minStepsPerSecond = 1.0; //< See documentation in header
+const double CursesWormsSimUIStrategy::maxLimitedStepsPerSecond = 1600.0; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+/// The carrot regrowth rates selected in turn by the 'c' key. Rates
+/// are multiples of 1/65536 so that WormsSim stores them exactly.
+const std::vector<double> CursesWormsSimUIStrategy::carrotRegrowthRates = {
+    0.0,
+    1.0 / 4096.0,
+    1.0 / 512.0,
+    1.0 / 64.0,
+};
+
+//////////////////////////////////////////////////////////////////////
+/// Characters that draw sparklines, from the lowest level to the
+/// highest
+const char CursesWormsSimUIStrategy::sparklineLevels[] = "_.-:=+*#";
+
 //////////////////////////////////////////////////////////////////////
-/// A map from integer attribute IDs stored by the simulation to
-/// corresponding display attributes in the user interface.
-std::map<int, int> CursesWormsSimUIStrategy::wormAttr = {
-    {0, COLOR_PAIR(4)},
-    {1, COLOR_PAIR(1)|A_STANDOUT},
-    {2, COLOR_PAIR(2)|A_STANDOUT},
-    {3, COLOR_PAIR(3)|A_STANDOUT},
-    {4, COLOR_PAIR(4)},
+/// A table indexed by integer attribute IDs stored by the simulation
+/// that stores corresponding display attributes in the user interface.
+const std::vector<int> CursesWormsSimUIStrategy::wormAttr = {
+    COLOR_PAIR(4),              // 0
+    COLOR_PAIR(1)|A_STANDOUT,   // 1
+    COLOR_PAIR(2)|A_STANDOUT,   // 2
+    COLOR_PAIR(3)|A_STANDOUT,   // 3
+    COLOR_PAIR(4),              // 4
 };
@@ -3,6 +3,7 @@
 
 #include "Worm.h"
 #include "WormsSim.h"
+#include "FixedTimestepScheduler.h"
 
 //////////////////////////////////////////////////////////////////////
 /// Instances of CursesWormsSimUIStrategy provide NCurses based
@@ -25,12 +26,12 @@ class CursesWormsSimUIStrategy : public AbstractWormsSimUIStrategy
 {
 private:
     static const char esc = '\033'; //< the ESC char ASCII code
-    static const int rowsInMessageArea = 5; //< Arbitrary number
+    static const int rowsInMessageArea = 9; //< Arbitrary number
+    static const int maxGraphRowLen = 240;  //< Arbitrary
+    static const double minStepsPerSecond;  //< Slowest rate '-' selects
+    static const double maxLimitedStepsPerSecond; //< Rate '-' selects after 'f'
 
     /* parameters for the 'graphical' (such as it is) display */
-    static int slowness;             //< Total number of delayQuantum intervals before each call to processUserInput() returns
-    static int delayQuantum;         //< an amount of time in milliseconds
-    static int delayRemaining;       //< remaining number of delayQuantum intervals before each call to processUserInput() returns
     static bool isPaused;            //< == true iff isPaused
 
     // See documentation in implementation file
@@ -40,17 +41,58 @@ private:
     static void startCurses(int &asogRows, int &asogCols);
 
     // See documentation in implementation file
-    static std::map<int, int> wormAttr;
+    static const std::vector<int> wormAttr;
+
+    // See documentation in implementation file
+    static const std::vector<double> carrotRegrowthRates;
+    
+    // See documentation in implementation file
+    static const char sparklineLevels[];
     
     /// The simulation instance to be displayed in a user interface
     /// specific way.
     WormsSim &m_sim;
+    
+    /// == true iff the next call to redrawDisplay() must redraw every
+    /// square rather than only the squares that changed
+    bool m_isFullRedrawNeeded;
+    
+    /// The worm shown to users with a distinctive display attribute
+    /// so that the user may kill it
+    WormsSim::worm_handle m_highlightedWorm;
+    
+    /// The squares drawn with the distinctive display attribute by
+    /// the last call to redrawDisplay()
+    std::vector<PositionSet::position> m_highlightedSquares;
+
+    /// Decides when steps run and when frames are drawn
+    FixedTimestepScheduler m_scheduler;
+
+    /// == true iff the most recent call to redrawDisplay() drew a
+    /// frame
+    bool m_isFrameDrawn;
+
+    // See documentation in implementation file
+    void drawSquareAt(int x, int y, int extraAttr = 0);
+
+    // See documentation in implementation file
+    void drawHighlightedWorm();
 
     // See documentation in implementation file
     int getOneChar();
 
     // See documentation in implementation file
     char handleUserKeyPress(char c);
+    
+    // See documentation in implementation file
+    static void formatSparkline(
+        const RingBuffer<long> &samples,
+        const char *label,
+        int width,
+        char *out);
+    
+    // See documentation in implementation file
+    void formatGraphs(char *out, std::size_t maxLen) const;
 
     /// Draw specified string of characters on row y on the display.
     void showMessage(
@@ -65,7 +107,8 @@ private:
 public:
     CursesWormsSimUIStrategy(
        WormsSim &sim) //< The simulation to be used by the strategy
-       : m_sim(sim)
+       : m_sim(sim), m_isFullRedrawNeeded(true), m_highlightedWorm({0, 0}),
+       m_scheduler(100.0, 30.0), m_isFrameDrawn(false)
     {}
     
     //////////////////////////////////////////////////////////////////
@@ -77,6 +120,16 @@ public:
        int &out_width,   //< The width of the available display in characters
        int &out_height); //< The height of the available display in characters
        
+    //////////////////////////////////////////////////////////////////
+    /// Returns the curses display attributes used to draw squares
+    /// whose simulation attribute is attr. Attributes of species
+    /// beyond the first three cycle through the attributes of the
+    /// first three, and other unknown attributes are drawn like
+    /// carrots.
+    static int getDisplayAttr(int attr) {
+        return (0 <= attr && attr < (int)wormAttr.size()) ? wormAttr[attr] :
+            (0 < attr) ? wormAttr[1 + (attr - 1) % 3] : wormAttr[0]; }
+    
     //////////////////////////////////////////////////////////////////
     /// Call this function to make the available display if any being
     /// used by CursesWormsSimUIStrategy available for use by other
@@ -84,16 +137,35 @@ public:
     static void releaseDisplay();
     
     //////////////////////////////////////////////////////////////////
-    /// Returns the total number of delayQuantum intervals before
-    /// each call to processUserInput() returns
-    static int getSlowness() { return slowness; }
+    /// Returns the number of simulation steps per second that
+    /// processUserInput() allows or 0 if steps run as fast as
+    /// possible. The default is 100.
+    double getTargetStepsPerSecond() const {
+        return m_scheduler.getTargetStepsPerSecond(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the number of simulation steps per second that
+    /// processUserInput() allows. Pass 0 to run steps as fast as
+    /// possible. The rate does not depend on how quickly the display
+    /// is drawn.
+    void setTargetStepsPerSecond(
+        double stepsPerSecond) { //< >= 0
+        m_scheduler.setTargetStepsPerSecond(stepsPerSecond); }
 
     //////////////////////////////////////////////////////////////////
-    /// Sets the total number of delayQuantum intervals before
-    /// each call to processUserInput() returns. Change the slowness
-    /// to speed up or slow down the rate at which the simulation
-    /// that calls processUserInput() can execute simulation steps.
-    static void setSlowness(int aSlowness) { slowness = slowness; }
+    /// Sets the maximum number of frames that redrawDisplay() draws
+    /// per second. Pass 0 to draw a frame every time. The default is
+    /// 30.
+    void setMaxFramesPerSecond(
+        double framesPerSecond) { //< >= 0
+        m_scheduler.setMaxFramesPerSecond(framesPerSecond); }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Call this function to make the next call to redrawDisplay()
+    /// redraw every square e.g. after the display has been resized or
+    /// overwritten. Otherwise, only squares that have changed are
+    /// redrawn.
+    void requestFullRedraw() { m_isFullRedrawNeeded = true; }
     
     //////////////////////////////////////////////////////////////////
     /// Call this function to request user interface specific
@@ -110,10 +182,11 @@ public:
     /// Override of AbstractWormsSimUIStrategy Template Method:
     /// Call his function to perform user interface specific logic
     /// including handling of any user input that may have been input
-    /// since the last call to this function.  Regardless of user
-    /// input, this function does not return for at least getSlowness()
-    /// number of delayQuantum time intervals have elapsed since the
-    /// call was made.
+    /// since the last call to this function. Waits for user input
+    /// until the next step is due according to
+    /// getTargetStepsPerSecond() or, while paused, until the user
+    /// resumes the simulation. When steps run as fast as possible,
+    /// input is only checked after frames are drawn.
     bool processUserInput();
 
     //////////////////////////////////////////////////////////////////
@@ -121,7 +194,12 @@ public:
     /// Call his function to request a redraw of the user interface
     /// using a user interface specific mechanism. Calling this
     /// function may result in calls to the strategy's sim to obtain
-    /// information about what to display.
+    /// information about what to display. Only squares that the sim
+    /// reports as changed are redrawn unless a full redraw has been
+    /// requested. Nothing is drawn if the previous frame was drawn
+    /// too recently for the maximum frame rate, in which case changes
+    /// accumulate until the next frame. As a side effect of drawing,
+    /// the sim's changed squares are cleared.
     void redrawDisplay();
 };
 
@@ -0,0 +1,27 @@
+#ifndef DEBUGINVARIANTS_H // Guard
+#define DEBUGINVARIANTS_H
+
+#include <cassert>
+
+
+//////////////////////////////////////////////////////////////////////
+/// assertInvariant() is used like assert() for checks whose cost
+/// grows with the size of the simulation, e.g. checks that visit
+/// every segment of a worm, so that they can be turned off
+/// separately from inexpensive assertions.
+///
+/// Design Notes:
+/// - The checks are compiled only when WORMS_DEBUG_INVARIANTS is
+/// defined. The default debug builds in the Makefile define it, and
+/// the release, lto, and pgo builds do not.
+/// - Like assert(), assertInvariant() does nothing when NDEBUG is
+/// defined even if WORMS_DEBUG_INVARIANTS is defined.
+///
+//////////////////////////////////////////////////////////////////////
+#ifdef WORMS_DEBUG_INVARIANTS
+#define assertInvariant(expression) assert(expression)
+#else
+#define assertInvariant(expression) ((void)0)
+#endif
+
+#endif // DEBUGINVARIANTS_H
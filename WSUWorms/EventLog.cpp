@@ -0,0 +1,209 @@
+#include "EventLog.h"
+#include <cassert>
+#include <cstring>
+
+const char EventLog::magic[8] = {'W', 'O', 'R', 'M', 'E', 'V', 'T', 'S'}; //< See documentation in header
+const std::uint32_t EventLog::version;              //< See documentation in header
+const std::size_t EventLog::bufferSize;             //< See documentation in header
+const std::size_t EventLog::maxEncodedEventSize;    //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+EventLog::reader::reader(const char *path) :
+    m_offset(0),
+    m_isValid(false),
+    m_width(0),
+    m_height(0),
+    m_previous()
+{
+    std::FILE *file = std::fopen(path, "rb");
+    if(nullptr == file)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    unsigned char chunk[64 * 1024];
+    std::size_t numRead = 0;
+    while(0 < (numRead = std::fread(chunk, 1, sizeof(chunk), file)))
+    {
+        m_bytes.insert(m_bytes.end(), chunk, chunk + numRead);
+    }
+    m_isValid = 0 == std::ferror(file);
+    std::fclose(file);
+
+    std::uint64_t fileVersion = 0;
+    std::uint64_t width = 0;
+    std::uint64_t height = 0;
+    if(m_isValid && sizeof(magic) <= m_bytes.size() &&
+        0 == std::memcmp(m_bytes.data(), magic, sizeof(magic)))
+    {
+        m_offset = sizeof(magic);
+        readVarint(fileVersion);
+        readVarint(width);
+        readVarint(height);
+    }
+    m_isValid = m_isValid && version == fileVersion &&
+        0 < width && width <= 0x7fffffff && 0 < height && height <= 0x7fffffff;
+    m_width = (int)width;
+    m_height = (int)height;
+}
+
+// See documentation in header
+bool EventLog::reader::next(event &out_event)
+{
+    if(!m_isValid || m_offset == m_bytes.size())
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    const unsigned char type = m_bytes[m_offset++];
+    std::uint64_t stepDelta = 0;
+    std::uint64_t wormIdDelta = 0;
+    std::uint64_t otherWormIdDelta = 0;
+    std::uint64_t xDelta = 0;
+    std::uint64_t yDelta = 0;
+    std::uint64_t value = 0;
+    readVarint(stepDelta);
+    readVarint(wormIdDelta);
+    readVarint(otherWormIdDelta);
+    readVarint(xDelta);
+    readVarint(yDelta);
+    readVarint(value);
+    if(!m_isValid || NUM_EVENT_TYPES <= type)
+    {   // !!!! EARLY EXIT !!!!
+        m_isValid = false;
+        return false;
+    }
+
+    // Undoes the zigzag encoding of signed varints
+    auto decodeSigned = [](std::uint64_t v) {
+        return (std::int64_t)(v >> 1) ^ -(std::int64_t)(v & 1); };
+
+    event e;
+    e.step = m_previous.step + stepDelta;
+    e.type = (event_type)type;
+    e.wormId = m_previous.wormId + (std::uint64_t)decodeSigned(wormIdDelta);
+    e.otherWormId = (0 == otherWormIdDelta) ? 0 :
+        e.wormId + (std::uint64_t)decodeSigned(otherWormIdDelta - 1);
+    e.x = (int)(m_previous.x + decodeSigned(xDelta));
+    e.y = (int)(m_previous.y + decodeSigned(yDelta));
+    e.value = (int)decodeSigned(value);
+
+    m_previous = e;
+    out_event = e;
+    return true;
+}
+
+// See documentation in header
+EventLog::EventLog() :
+    m_file(nullptr),
+    m_buffer(new unsigned char[bufferSize]),
+    m_numBuffered(0),
+    m_previous(),
+    m_numEvents(0),
+    m_numBytes(0),
+    m_hasFailed(false)
+{
+}
+
+// See documentation in header
+EventLog::~EventLog()
+{
+    close();
+    delete [] m_buffer;
+}
+
+// See documentation in header
+bool EventLog::open(const char *path, int width, int height)
+{
+    assert(0 < width && 0 < height);
+
+    close();
+    m_file = std::fopen(path, "wb");
+    if(nullptr == m_file)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    m_previous = event();
+    m_numEvents = 0;
+    m_hasFailed = false;
+    std::memcpy(m_buffer, magic, sizeof(magic));
+    m_numBuffered = sizeof(magic);
+    encodeVarint(version);
+    encodeVarint((std::uint64_t)width);
+    encodeVarint((std::uint64_t)height);
+    m_numBytes = (long long)m_numBuffered;
+
+    return true;
+}
+
+// See documentation in header
+bool EventLog::close()
+{
+    if(nullptr == m_file)
+    {   // !!!! EARLY EXIT !!!!
+        return true;
+    }
+
+    writeBuffer();
+    m_hasFailed = 0 != std::fclose(m_file) || m_hasFailed;
+    m_file = nullptr;
+    return !m_hasFailed;
+}
+
+// See documentation in header
+const char *EventLog::getEventTypeName(event_type type)
+{
+    static const char *names[NUM_EVENT_TYPES] = {
+        "born", "sliced", "ate", "died"};
+
+    assert(0 <= type && type < NUM_EVENT_TYPES);
+    return names[type];
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Writes every buffered byte to the file and empties the buffer.
+/// Failures are remembered and reported by close().
+void EventLog::writeBuffer()
+{
+    assert(nullptr != m_file);
+
+    if(m_numBuffered != std::fwrite(m_buffer, 1, m_numBuffered, m_file))
+    {
+        m_hasFailed = true;
+    }
+    m_numBuffered = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Decodes the varint at the current offset into out_value and
+/// advances past it. Makes the reader invalid and returns false if
+/// the file ends within the varint or the varint has more than 64
+/// bits.
+bool EventLog::reader::readVarint(std::uint64_t &out_value)
+{
+    std::uint64_t result = 0;
+    for(int shift = 0; m_isValid && m_offset < m_bytes.size() && shift < 64;
+        shift += 7)
+    {
+        const unsigned char byte = m_bytes[m_offset++];
+        result |= (std::uint64_t)(byte & 0x7f) << shift;
+        if(0 == (byte & 0x80))
+        {   // !!!! EARLY EXIT !!!!
+            out_value = result;
+            return true;
+        }
+    }
+
+    m_isValid = false;
+    return false;
+}
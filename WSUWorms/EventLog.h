@@ -0,0 +1,253 @@
+#ifndef EVENTLOG_H // Guard
+#define EVENTLOG_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////
+/// EventLog streams the population events of a simulation to a file:
+/// worms being born, slicing other worms, eating other worms, and
+/// dying. Every worm that is logged has exactly one BORN event, and
+/// every worm that stops living has exactly one DIED event, so the
+/// lifetime, ancestry, and cause of death of every worm can be
+/// reconstructed offline. Use reader to decode a log.
+///
+/// A log file starts with a header:
+/// - 8 bytes: the characters of magic
+/// - varint: the format version
+/// - varint: the width of the simulation's board
+/// - varint: the height of the simulation's board
+///
+/// Each event follows as:
+/// - 1 byte: the event_type
+/// - varint: step minus the step of the previous event
+/// - signed varint: wormId minus the wormId of the previous event
+/// - varint: 0 if otherWormId is 0, otherwise 1 plus the signed varint
+///   encoding of otherWormId minus wormId
+/// - signed varints: x and y minus those of the previous event
+/// - signed varint: value
+///
+/// Varints store 7 bits per byte, least significant bits first, with
+/// the high bit of each byte set if more bytes follow. Signed values
+/// are zigzag encoded first so that small negative values are short.
+/// The first event is encoded relative to an event with every field
+/// 0. Consecutive events usually happen in the same step to nearby
+/// worms with similar ids, so a typical event takes 8 to 12 bytes.
+///
+/// Design Notes:
+/// - Events are encoded into a buffer owned by the log and written to
+/// the file only when the buffer is full, so recording an event
+/// never takes a lock or makes a system call. All functions must be
+/// called by the thread that runs the simulation; simulations that
+/// run on different threads each use their own log.
+/// - The format has no byte order or word size dependencies.
+///
+//////////////////////////////////////////////////////////////////////
+class EventLog
+{
+public:
+    /// The kinds of events
+    typedef enum
+    {
+        BORN,    //< wormId was created; otherWormId is the worm it was sliced from or 0
+        SLICED,  //< wormId sliced otherWormId at {x,y}
+        ATE,     //< wormId ate otherWormId with its head at {x,y}
+        DIED,    //< wormId stopped living with its head at {x,y}
+        NUM_EVENT_TYPES
+    } event_type;
+
+    /// The values of DIED events
+    typedef enum
+    {
+        STARVED, //< The worm's stomach emptied
+        EATEN,   //< Another worm ate the worm
+        KILLED   //< The worm was killed e.g. at the request of a user
+    } death_cause;
+
+    /// One population event. The meaning of value depends on type:
+    /// - BORN: the index of the worm's species in WormsSim::getSpecies()
+    /// - SLICED: the number of segments sliced off the victim
+    /// - ATE: the food value of the eaten worm
+    /// - DIED: the death_cause
+    struct event
+    {
+        std::uint64_t step;        //< The number of steps run when the event happened
+        event_type type;           //< The kind of event
+        std::uint64_t wormId;      //< The generation of the worm that the event is about
+        std::uint64_t otherWormId; //< The generation of another worm or 0
+        int x;                     //< Board column of the event
+        int y;                     //< Board row of the event
+        int value;                 //< See above
+    };
+
+    /// The first bytes of every event log file
+    static const char magic[8];
+
+    /// The version of the format written
+    static const std::uint32_t version = 1;
+
+    /// The number of bytes buffered before writing to the file
+    static const std::size_t bufferSize = 64 * 1024;
+
+    /// The largest number of bytes that one encoded event takes
+    static const std::size_t maxEncodedEventSize = 1 + 6 * 10;
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances read the events of a log file in the order in which
+    /// they were recorded.
+    class reader
+    {
+    private:
+        std::vector<unsigned char> m_bytes; //< The whole file
+        std::size_t m_offset;               //< Offset of the next byte to read
+        bool m_isValid;                     //< false after any failure
+        int m_width;                        //< See getWidth()
+        int m_height;                       //< See getHeight()
+        event m_previous;                   //< The last event read
+
+        // See documentation in implementation file
+        bool readVarint(std::uint64_t &out_value);
+
+    public:
+        //////////////////////////////////////////////////////////////
+        /// Reads the file at path into memory and decodes its header.
+        /// The reader is invalid if the file cannot be read or does
+        /// not start with a header of this version.
+        explicit reader(const char *path);
+
+        /// @name Non-mutating Accessors
+        /// @{
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+
+        //////////////////////////////////////////////////////////////
+        /// Returns true iff every event read so far was well formed.
+        bool isValid() const { return m_isValid; }
+
+        //////////////////////////////////////////////////////////////
+        /// Returns true iff the reader is valid and every event has
+        /// been read.
+        bool isAtEnd() const {
+            return m_isValid && m_offset == m_bytes.size(); }
+        /// @}
+
+        //////////////////////////////////////////////////////////////
+        /// Decodes the next event into out_event. Returns false
+        /// without changing out_event at the end of the file or if
+        /// the next event is malformed, in which case the reader
+        /// becomes invalid.
+        bool next(event &out_event);
+    };
+
+private:
+    std::FILE *m_file;          //< The open log file or nullptr
+    unsigned char *m_buffer;    //< bufferSize bytes of encoded events
+    std::size_t m_numBuffered;  //< Bytes in m_buffer not yet written
+    event m_previous;           //< The last event recorded
+    long long m_numEvents;      //< See getNumEvents()
+    long long m_numBytes;       //< See getNumBytes()
+    bool m_hasFailed;           //< true after any write error
+
+    // See documentation in implementation file
+    void writeBuffer();
+
+    /// Appends value to m_buffer as a varint
+    void encodeVarint(std::uint64_t value)
+    {
+        while(0x80 <= value)
+        {
+            m_buffer[m_numBuffered++] = (unsigned char)(value | 0x80);
+            value >>= 7;
+        }
+        m_buffer[m_numBuffered++] = (unsigned char)value;
+    }
+
+    /// Appends value to m_buffer as a zigzag encoded varint
+    void encodeSignedVarint(std::int64_t value)
+    {
+        encodeVarint(((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a log that is not open.
+    EventLog();
+
+    /// Closes the log
+    ~EventLog();
+
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    /// @name Non-mutating Accessors
+    /// @{
+    bool isOpen() const { return nullptr != m_file; }
+
+    /// Returns the number of events recorded since the log was opened
+    long long getNumEvents() const { return m_numEvents; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of bytes of the file including the header
+    /// and events that are still buffered.
+    long long getNumBytes() const { return m_numBytes; }
+    /// @}
+
+    /// @name Functions that mutate the log
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Closes any open file, creates a new file at path replacing any
+    /// existing file, and writes a header for a simulation whose board
+    /// has width columns and height rows. Returns false if the file
+    /// could not be created.
+    bool open(const char *path, int width, int height);
+
+    //////////////////////////////////////////////////////////////////
+    /// Writes any buffered events and closes the file. Returns false
+    /// if any part of the log could not be written. Does nothing and
+    /// returns true if the log is not open.
+    bool close();
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends e to the log, which must be open. e.step must not be
+    /// less than the step of the previous event.
+    void record(const event &e)
+    {
+        if(bufferSize - m_numBuffered < maxEncodedEventSize)
+        {
+            writeBuffer();
+        }
+
+        const std::size_t start = m_numBuffered;
+        m_buffer[m_numBuffered++] = (unsigned char)e.type;
+        encodeVarint(e.step - m_previous.step);
+        encodeSignedVarint((std::int64_t)(e.wormId - m_previous.wormId));
+        if(0 == e.otherWormId)
+        {
+            encodeVarint(0);
+        }
+        else
+        {
+            const std::int64_t d = (std::int64_t)(e.otherWormId - e.wormId);
+            encodeVarint((((std::uint64_t)d << 1) ^ (std::uint64_t)(d >> 63)) + 1);
+        }
+        encodeSignedVarint((std::int64_t)e.x - m_previous.x);
+        encodeSignedVarint((std::int64_t)e.y - m_previous.y);
+        encodeSignedVarint(e.value);
+
+        m_previous = e;
+        m_numEvents += 1;
+        m_numBytes += (long long)(m_numBuffered - start);
+    }
+    /// @}
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns a short name for type suitable for display or as a
+    /// value in comma separated values e.g. "sliced".
+    static const char *getEventTypeName(event_type type);
+};
+
+#endif // EVENTLOG_H
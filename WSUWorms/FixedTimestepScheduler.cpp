@@ -0,0 +1,111 @@
+#include "FixedTimestepScheduler.h"
+#include <cassert>
+
+const double FixedTimestepScheduler::maxLagSeconds = 0.25; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+FixedTimestepScheduler::FixedTimestepScheduler(
+    double targetStepsPerSecond,
+    double maxFramesPerSecond) :
+    m_targetStepsPerSecond(0.0),
+    m_maxFramesPerSecond(0.0)
+{
+    setTargetStepsPerSecond(targetStepsPerSecond);
+    setMaxFramesPerSecond(maxFramesPerSecond);
+}
+
+// See documentation in header
+int FixedTimestepScheduler::getMillisecondsUntilNextStep() const
+{
+    const clock::duration remaining = m_nextStepTime - clock::now();
+    if(isUnlimited() || remaining <= clock::duration::zero())
+    {   // !!!! EARLY EXIT !!!!
+        return 0;
+    }
+
+    std::chrono::milliseconds result =
+        std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+    if(result < remaining) { result += std::chrono::milliseconds(1); }
+    return (int)result.count();
+}
+
+// See documentation in header
+void FixedTimestepScheduler::setTargetStepsPerSecond(double stepsPerSecond)
+{
+    assert(0.0 <= stepsPerSecond);
+
+    m_targetStepsPerSecond = stepsPerSecond;
+    m_stepPeriod = periodOf(stepsPerSecond);
+    m_nextStepTime = clock::now();
+}
+
+// See documentation in header
+void FixedTimestepScheduler::setMaxFramesPerSecond(double framesPerSecond)
+{
+    assert(0.0 <= framesPerSecond);
+
+    m_maxFramesPerSecond = framesPerSecond;
+    m_framePeriod = periodOf(framesPerSecond);
+    m_nextFrameTime = clock::now();
+}
+
+// See documentation in header
+void FixedTimestepScheduler::restart()
+{
+    m_nextStepTime = clock::now();
+    m_nextFrameTime = m_nextStepTime;
+}
+
+// See documentation in header
+void FixedTimestepScheduler::onStepFinished()
+{
+    if(isUnlimited())
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    const clock::time_point now = clock::now();
+    m_nextStepTime += m_stepPeriod;
+    if(m_nextStepTime + std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(maxLagSeconds)) < now)
+    {
+        m_nextStepTime = now;
+    }
+}
+
+// See documentation in header
+void FixedTimestepScheduler::onFrameDrawn()
+{
+    const clock::time_point now = clock::now();
+    m_nextFrameTime += m_framePeriod;
+    if(m_nextFrameTime <= now)
+    {
+        // Drawing is behind: the earliest next frame is one whole
+        // period from now so that frames are never drawn back to back
+        m_nextFrameTime = now + m_framePeriod;
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the time between events that happen ratePerSecond times
+/// per second or 0 if ratePerSecond is 0.
+FixedTimestepScheduler::clock::duration FixedTimestepScheduler::periodOf(
+    double ratePerSecond)
+{
+    if(0.0 >= ratePerSecond)
+    {   // !!!! EARLY EXIT !!!!
+        return clock::duration::zero();
+    }
+
+    return std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(1.0 / ratePerSecond));
+}
@@ -0,0 +1,96 @@
+#ifndef FIXEDTIMESTEPSCHEDULER_H // Guard
+#define FIXEDTIMESTEPSCHEDULER_H
+
+#include <chrono>
+
+
+//////////////////////////////////////////////////////////////////////
+/// FixedTimestepScheduler decides when simulation steps run and when
+/// frames are drawn so that the simulation rate does not depend on
+/// how quickly a display can be drawn.
+///
+/// Steps are scheduled at fixed intervals of 1 / target steps per
+/// second measured from a start time, so that waiting slightly too
+/// long for one step does not delay later steps. Frames are drawn at
+/// most at the maximum frame rate; steps that finish between frames
+/// are not drawn individually.
+///
+/// Design Notes:
+/// - A target of 0 steps per second runs steps as fast as possible,
+/// and a maximum of 0 frames per second draws a frame after every
+/// step.
+/// - If steps fall behind schedule by more than maxLagSeconds, e.g.
+/// because the machine is too slow for the target rate or the
+/// simulation was paused, the schedule restarts from the current
+/// time instead of running a burst of steps to catch up.
+///
+//////////////////////////////////////////////////////////////////////
+class FixedTimestepScheduler
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    /// The largest delay of steps behind schedule that is made up
+    static const double maxLagSeconds;
+
+private:
+    double m_targetStepsPerSecond;   //< 0 or steps per second
+    double m_maxFramesPerSecond;     //< 0 or frames per second
+    clock::duration m_stepPeriod;    //< Time between steps
+    clock::duration m_framePeriod;   //< Minimum time between frames
+    clock::time_point m_nextStepTime;  //< When the next step is due
+    clock::time_point m_nextFrameTime; //< When the next frame may be drawn
+
+    // See documentation in implementation file
+    static clock::duration periodOf(double ratePerSecond);
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a scheduler whose first step and frame are due now.
+    FixedTimestepScheduler(
+        double targetStepsPerSecond, //< >= 0
+        double maxFramesPerSecond);  //< >= 0
+
+    /// @name Non-mutating Accessors
+    /// @{
+    double getTargetStepsPerSecond() const { return m_targetStepsPerSecond; }
+    double getMaxFramesPerSecond() const { return m_maxFramesPerSecond; }
+    bool isUnlimited() const { return 0.0 == m_targetStepsPerSecond; }
+
+    /// Returns true iff a frame may be drawn now
+    bool isFrameDue() const { return clock::now() >= m_nextFrameTime; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of whole milliseconds, rounded up, until the
+    /// next step is due or 0 if it is already due.
+    int getMillisecondsUntilNextStep() const;
+    /// @}
+
+    /// @name Functions that mutate the scheduler
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the target number of steps per second and restarts the
+    /// schedule so that the next step is due now.
+    void setTargetStepsPerSecond(
+        double stepsPerSecond); //< >= 0
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the maximum number of frames drawn per second.
+    void setMaxFramesPerSecond(
+        double framesPerSecond); //< >= 0
+
+    //////////////////////////////////////////////////////////////////
+    /// Makes the next step and the next frame due now e.g. after the
+    /// simulation was paused.
+    void restart();
+
+    /// Call after every step to schedule the next step
+    void onStepFinished();
+
+    /// Call after every frame to schedule the earliest next frame
+    void onFrameDrawn();
+    /// @}
+};
+
+#endif // FIXEDTIMESTEPSCHEDULER_H
@@ -0,0 +1,48 @@
+#include "HeadlessWormsSimUIStrategy.h"
+#include "HeapAllocationCounter.h"
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+HeadlessWormsSimUIStrategy::HeadlessWormsSimUIStrategy(
+    WormsSim &sim,
+    long maxNumberOfSteps,
+    bool stopsAtExtinction) :
+    m_sim(sim),
+    m_maxNumberOfSteps(maxNumberOfSteps),
+    m_numberOfSteps(0),
+    m_numberOfWormSteps(0),
+    m_extinctionStep(-1),
+    m_numHeapAllocationsAtHalfway(-1),
+    m_stopsAtExtinction(stopsAtExtinction)
+{
+    assert(0 < maxNumberOfSteps); // at least one step always runs
+}
+
+// See documentation in header
+bool HeadlessWormsSimUIStrategy::processUserInput()
+{
+    const int numLivingWorms = m_sim.getPopulation().getNumLiving();
+    
+    m_numberOfSteps += 1;
+    m_numberOfWormSteps += numLivingWorms;
+    if(0 == numLivingWorms && 0 > m_extinctionStep)
+    {
+        m_extinctionStep = m_numberOfSteps;
+    }
+    if(m_maxNumberOfSteps / 2 == m_numberOfSteps)
+    {
+        m_numHeapAllocationsAtHalfway = HeapAllocationCounter::getCount();
+    }
+    
+    return m_numberOfSteps >= m_maxNumberOfSteps ||
+        (m_stopsAtExtinction && 0 <= m_extinctionStep);
+}
+
+// See documentation in header
+void HeadlessWormsSimUIStrategy::redrawDisplay()
+{
+    m_sim.clearChangedSquares();
+}
@@ -0,0 +1,89 @@
+#ifndef HEADLESSWORMSSIMUISTRATEGY_H // Guard
+#define HEADLESSWORMSSIMUISTRATEGY_H
+
+#include "WormsSim.h"
+
+//////////////////////////////////////////////////////////////////////
+/// Instances of HeadlessWormsSimUIStrategy run a WormsSim instance
+/// for a fixed number of simulation steps without any display, user
+/// input, or delays between steps. Use this strategy to run
+/// simulations as fast as possible e.g. on machines without a
+/// terminal.
+///
+/// Design Notes:
+/// - HeadlessWormsSimUIStrategy implements the interface specified by
+/// the abstract AbstractWormsSimUIStrategy class and participates in
+/// the Strategy design pattern. WormsSim is unaware of whether or
+/// not a display exists.
+/// - In addition to ending the simulation, the strategy records
+/// simple statistics about the steps it has observed. The heap
+/// allocation count recorded halfway through the steps lets callers
+/// check that later steps run without allocating memory.
+///
+//////////////////////////////////////////////////////////////////////
+class HeadlessWormsSimUIStrategy : public AbstractWormsSimUIStrategy
+{
+private:
+    /// The simulation instance to be run
+    WormsSim &m_sim;
+
+    /// The number of steps after which processUserInput() ends the
+    /// simulation
+    long m_maxNumberOfSteps;
+
+    /// The number of steps observed since the strategy was created
+    long m_numberOfSteps;
+
+    /// The sum over all observed steps of the number of living worms
+    /// at the end of each step
+    long long m_numberOfWormSteps;
+
+    /// The number of steps observed when the number of living worms
+    /// first became 0 or -1 if that has not happened
+    long m_extinctionStep;
+    
+    /// HeapAllocationCounter::getCount() when half of the maximum
+    /// number of steps had been observed or -1 if that has not
+    /// happened
+    long m_numHeapAllocationsAtHalfway;
+
+    /// == true iff processUserInput() ends the simulation as soon as
+    /// no worms are alive
+    bool m_stopsAtExtinction;
+
+public:
+    HeadlessWormsSimUIStrategy(
+        WormsSim &sim,        //< The simulation to be used by the strategy
+        long maxNumberOfSteps, //< The number of steps to run before ending the simulation
+        bool stopsAtExtinction = false //< Also end the simulation when no worms are alive
+    );
+
+    /// @name Non-mutating Accessors
+    /// @{
+    long getNumberOfSteps() const { return m_numberOfSteps; }
+    long long getNumberOfWormSteps() const { return m_numberOfWormSteps; }
+    long getExtinctionStep() const { return m_extinctionStep; }
+    long getNumHeapAllocationsAtHalfway() const { return m_numHeapAllocationsAtHalfway; }
+    /// @}
+
+    //////////////////////////////////////////////////////////////////
+    /// Override of AbstractWormsSimUIStrategy Template Method:
+    /// Returns the simulation with which the strategy was created.
+    WormsSim &getCurrentSim() { return m_sim; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Override of AbstractWormsSimUIStrategy Template Method:
+    /// Records statistics about the step that just completed and
+    /// returns true once the maximum number of steps has been
+    /// observed or, if the strategy stops at extinction, once no
+    /// worms are alive. This function never waits.
+    bool processUserInput();
+
+    //////////////////////////////////////////////////////////////////
+    /// Override of AbstractWormsSimUIStrategy Template Method:
+    /// Draws nothing. The sim's changed squares are cleared so that
+    /// they do not accumulate.
+    void redrawDisplay();
+};
+
+#endif // HEADLESSWORMSSIMUISTRATEGY_H
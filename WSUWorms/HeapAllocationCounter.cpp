@@ -0,0 +1,52 @@
+#include "HeapAllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/// The number of allocations made by the replacement operator new
+static std::atomic<long> s_numAllocations(0);
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+long HeapAllocationCounter::getCount()
+{
+    return s_numAllocations.load(std::memory_order_relaxed);
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                 REPLACEMENT GLOBAL ALLOCATION FUNCTIONS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Counts the allocation and then allocates like the standard library
+/// version. The array and nothrow versions of operator new provided
+/// by the standard library call this function.
+void *operator new(std::size_t size)
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+    
+    void *result = std::malloc(0 < size ? size : 1);
+    if(nullptr == result)
+    {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Frees memory allocated by the replacement operator new.
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Frees memory allocated by the replacement operator new.
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
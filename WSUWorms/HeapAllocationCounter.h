@@ -0,0 +1,29 @@
+#ifndef HEAPALLOCATIONCOUNTER_H // Guard
+#define HEAPALLOCATIONCOUNTER_H
+
+
+//////////////////////////////////////////////////////////////////////
+/// HeapAllocationCounter counts calls to the global operator new made
+/// by any thread of the program.
+///
+/// Design Notes:
+/// - Counting works by replacing the global operator new and operator
+/// delete functions. Only programs that link HeapAllocationCounter.cpp
+/// count allocations; linking it into a program changes every heap
+/// allocation made by that program.
+/// - The count is intended for verifying that code does not allocate
+/// e.g. that steady state simulation steps reuse memory. Reading the
+/// count is cheap, but it includes allocations made concurrently by
+/// other threads.
+///
+//////////////////////////////////////////////////////////////////////
+class HeapAllocationCounter
+{
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of times the global operator new has
+    /// allocated memory since the program started.
+    static long getCount();
+};
+
+#endif // HEAPALLOCATIONCOUNTER_H
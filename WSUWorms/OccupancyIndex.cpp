@@ -0,0 +1,74 @@
+#include "OccupancyIndex.h"
+
+const int OccupancyIndex::none; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+OccupancyIndex::OccupancyIndex(int width, int height) :
+    m_firstNodeAt(width, height, none),
+    m_firstFreeNode(none)
+{
+}
+
+// See documentation in header
+void OccupancyIndex::clear()
+{
+    m_firstNodeAt.fill(none);
+    m_nodes.clear();
+    m_firstFreeNode = none;
+}
+
+// See documentation in header
+void OccupancyIndex::insert(int x, int y, occupant o)
+{
+    int i = m_firstFreeNode;
+    if(none != i)
+    {
+        m_firstFreeNode = m_nodes[i].next;
+    }
+    else
+    {
+        i = (int)m_nodes.size();
+        m_nodes.push_back(node());
+    }
+    
+    int &first = m_firstNodeAt.at(x, y);
+    m_nodes[i].o = o;
+    m_nodes[i].next = first;
+    first = i;
+    
+    assert(m_firstNodeAt.at(x, y) == i);
+}
+
+// See documentation in header
+void OccupancyIndex::remove(int x, int y, occupant o)
+{
+    int *link = &m_firstNodeAt.at(x, y);
+    while(none != *link && !(m_nodes[*link].o == o))
+    {
+        link = &m_nodes[*link].next;
+    }
+    
+    assert(none != *link); // o must be present
+    int i = *link;
+    *link = m_nodes[i].next;
+    m_nodes[i].next = m_firstFreeNode;
+    m_firstFreeNode = i;
+}
+
+// See documentation in header
+void OccupancyIndex::replace(
+    int x, int y, occupant oldOccupant, occupant newOccupant)
+{
+    int i = m_firstNodeAt.at(x, y);
+    while(none != i && !(m_nodes[i].o == oldOccupant))
+    {
+        i = m_nodes[i].next;
+    }
+    
+    assert(none != i); // oldOccupant must be present
+    m_nodes[i].o = newOccupant;
+}
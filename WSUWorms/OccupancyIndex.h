@@ -0,0 +1,112 @@
+#ifndef OCCUPANCYINDEX_H // Guard
+#define OCCUPANCYINDEX_H
+
+#include <vector>
+#include <cassert>
+#include "Board.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// OccupancyIndex records which worm segments occupy each position of
+/// a board so that the segments at any position can be found without
+/// examining every segment of every worm.
+///
+/// Each board position stores the start of a short singly linked list
+/// of occupants. Many segments may occupy the same position e.g. all
+/// of the segments of a newly created worm start at the same
+/// position, so the lists are unbounded, but in practice they contain
+/// very few occupants.
+///
+/// Design Notes:
+/// - An occupant identifies a segment by the index of its worm within
+/// the simulation and by the segment's serial number (See
+/// Worm::getTailSerial()). Serial numbers do not change when a worm
+/// moves, so moving a worm requires only removing the occupant for
+/// its old tail and inserting an occupant for its new head.
+/// - OccupancyIndex knows nothing about worms. Keeping the index
+/// consistent with the worms is the responsibility of WormsSim.
+///
+//////////////////////////////////////////////////////////////////////
+class OccupancyIndex
+{
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this structure identify one worm segment.
+    struct occupant
+    {
+        int wormIndex;       //< Index of the worm in the simulation
+        unsigned int serial; //< Serial number of the segment in the worm
+
+        bool operator==(const occupant &other) const
+        {
+            return wormIndex == other.wormIndex && serial == other.serial;
+        }
+    };
+
+private:
+    static const int none = -1; //< Marks the end of a list of nodes
+
+    /// Element of a singly linked list of occupants
+    struct node
+    {
+        occupant o;  //< The occupant
+        int next;    //< Index of next node in the list or none
+    };
+
+    /// Index within m_nodes of the first node at each board position
+    Board<int> m_firstNodeAt;
+
+    /// Storage for all nodes. Removed nodes are recycled via a list
+    /// of free nodes so that storage does not grow without bound.
+    std::vector<node> m_nodes;
+
+    /// Index within m_nodes of the first unused node or none
+    int m_firstFreeNode;
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs an index for a board with width columns and height
+    /// rows. Initially, no position has any occupants.
+    OccupancyIndex(
+        int width = 0, //< The number of columns in the board
+        int height = 0 //< The number of rows in the board
+    );
+
+    //////////////////////////////////////////////////////////////////
+    /// Removes all occupants from all positions.
+    void clear();
+
+    //////////////////////////////////////////////////////////////////
+    /// Makes room for numOccupants occupants so that inserting that
+    /// many occupants does not reallocate storage.
+    void reserve(std::size_t numOccupants) { m_nodes.reserve(numOccupants); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Records that o occupies position {x, y}.
+    void insert(int x, int y, occupant o);
+
+    //////////////////////////////////////////////////////////////////
+    /// Removes the record that o occupies position {x, y}. The record
+    /// must exist.
+    void remove(int x, int y, occupant o);
+
+    //////////////////////////////////////////////////////////////////
+    /// Replaces the record that oldOccupant occupies position {x, y}
+    /// with a record that newOccupant occupies the same position. The
+    /// record of oldOccupant must exist.
+    void replace(int x, int y, occupant oldOccupant, occupant newOccupant);
+
+    //////////////////////////////////////////////////////////////////
+    /// Calls function once with each occupant at position {x, y}.
+    /// Occupants are visited in no particular order.
+    template <typename Function>
+    void forEachOccupantAt(int x, int y, Function function) const
+    {
+        for(int i = m_firstNodeAt.at(x, y); none != i; i = m_nodes[i].next)
+        {
+            function(m_nodes[i].o);
+        }
+    }
+};
+
+#endif // OCCUPANCYINDEX_H
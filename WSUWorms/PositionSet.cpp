@@ -0,0 +1,35 @@
+#include "PositionSet.h"
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+PositionSet::PositionSet(int width, int height) :
+    m_isMember(width, height, 0),
+    m_containsEverything(false)
+{
+}
+
+// See documentation in header
+void PositionSet::insertEverything()
+{
+    // Listed members are redundant once the set contains everything
+    clear();
+    m_containsEverything = true;
+    
+    assert(m_members.empty());
+}
+
+// See documentation in header
+void PositionSet::clear()
+{
+    for(const position &p : m_members)
+    {
+        m_isMember.at(p.x, p.y) = 0;
+    }
+    m_members.clear();
+    m_containsEverything = false;
+    
+    assert(m_members.empty());
+}
@@ -0,0 +1,81 @@
+#ifndef POSITIONSET_H // Guard
+#define POSITIONSET_H
+
+#include <vector>
+#include "Board.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// PositionSet encapsulates a set of board positions. Inserting a
+/// position, testing membership, and clearing the set all cost time
+/// proportional to the number of positions involved rather than to
+/// the number of positions in the board. Members are available in
+/// the order in which they were first inserted.
+///
+/// Additionally, a PositionSet may be marked as containing every
+/// position of the board without listing every position. This is
+/// useful e.g. to record that every square of a board has changed.
+///
+//////////////////////////////////////////////////////////////////////
+class PositionSet
+{
+public:
+    /// A position within a board
+    struct position
+    {
+        int x, y;         //< coordinates of the position
+    };
+
+private:
+    Board<unsigned char> m_isMember;  //< Nonzero for listed members
+    std::vector<position> m_members;  //< Listed members in insertion order
+    bool m_containsEverything;        //< true iff every position is a member
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs an empty set of positions within a board with width
+    /// columns and height rows.
+    PositionSet(
+        int width = 0, //< The number of columns in the board
+        int height = 0 //< The number of rows in the board
+    );
+
+    /// @name Non-mutating Accessors
+    /// @{
+    bool containsEverything() const { return m_containsEverything; }
+    bool contains(int x, int y) const {
+        return m_containsEverything || 0 != m_isMember.at(x, y); }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the listed members of the set. When
+    /// containsEverything() returns true, the returned positions are
+    /// not necessarily all of the members.
+    const std::vector<position> &getPositions() const { return m_members; }
+    /// @}
+
+    /// @name Functions that mutate the set
+    /// @{
+    
+    //////////////////////////////////////////////////////////////////
+    /// Adds position {x, y} to the set if it is not already a member.
+    void insert(int x, int y)
+    {
+        if(!m_containsEverything && 0 == m_isMember.at(x, y))
+        {
+            m_isMember.at(x, y) = 1;
+            position p = {x, y};
+            m_members.push_back(p);
+        }
+    }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Makes every position of the board a member of the set.
+    void insertEverything();
+    
+    //////////////////////////////////////////////////////////////////
+    /// Removes all members from the set.
+    void clear();
+    /// @}
+};
+
+#endif // POSITIONSET_H
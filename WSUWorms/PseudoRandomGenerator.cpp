@@ -0,0 +1,56 @@
+#include "PseudoRandomGenerator.h"
+
+const int PseudoRandomGenerator::stateSize; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+void PseudoRandomGenerator::setSeed(std::uint64_t seed)
+{
+    // Expand the seed into the full generator state with the
+    // SplitMix64 generator as recommended by the xoshiro authors.
+    // SplitMix64 never produces four consecutive zero words, so the
+    // state is never all zero.
+    for(int i = 0; i < stateSize; ++i)
+    {
+        seed += 0x9e3779b97f4a7c15ULL;
+        std::uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        m_state[i] = z ^ (z >> 31);
+    }
+}
+
+// See documentation in header
+void PseudoRandomGenerator::writeTo(Snapshot::writer &out) const
+{
+    for(int i = 0; i < stateSize; ++i)
+    {
+        out.write(m_state[i]);
+    }
+}
+
+// See documentation in header
+bool PseudoRandomGenerator::readFrom(Snapshot::reader &in)
+{
+    std::uint64_t state[stateSize];
+    std::uint64_t anyBits = 0;
+    for(int i = 0; i < stateSize; ++i)
+    {
+        in.read(state[i]);
+        anyBits |= state[i];
+    }
+    if(!in.isValid() || 0 == anyBits)
+    {   // !!!! EARLY EXIT !!!! An all zero state would only produce zeros
+        in.fail();
+        return false;
+    }
+
+    for(int i = 0; i < stateSize; ++i)
+    {
+        m_state[i] = state[i];
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef PSEUDORANDOMGENERATOR_H // Guard
+#define PSEUDORANDOMGENERATOR_H
+
+#include <cstdint>
+#include <cassert>
+#include "Snapshot.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// PseudoRandomGenerator produces a repeatable sequence of pseudo
+/// random numbers determined entirely by a seed. The xoshiro256**
+/// algorithm by David Blackman and Sebastiano Vigna is used:
+/// http://prng.di.unimi.it
+/// It is small, very fast, and has good statistical quality.
+///
+/// Design Notes:
+/// - Each simulation owns its own generator, so simulations neither
+/// share nor contend for generator state, and any simulation can be
+/// reproduced exactly by reusing its seed.
+/// - Functions called for every random number are defined in this
+/// header so that they may be inlined.
+///
+//////////////////////////////////////////////////////////////////////
+class PseudoRandomGenerator
+{
+public:
+    /// The number of 64 bit words of generator state
+    static const int stateSize = 4;
+
+private:
+    std::uint64_t m_state[stateSize]; //< Never all zero
+
+    static std::uint64_t rotateLeft(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a generator whose sequence is determined by seed.
+    explicit PseudoRandomGenerator(std::uint64_t seed = 0) { setSeed(seed); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Restarts the generator's sequence as determined by seed. Any
+    /// seed value including 0 is acceptable.
+    void setSeed(std::uint64_t seed);
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the generator's state to out so that readFrom() can
+    /// continue the sequence exactly where it is now.
+    void writeTo(Snapshot::writer &out) const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Replaces the generator's state with a state read from in that
+    /// was written by writeTo(). Returns false, fails in, and leaves
+    /// the generator unchanged if no valid state could be read.
+    bool readFrom(Snapshot::reader &in);
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the next pseudo random 64 bit number in the sequence.
+    std::uint64_t next()
+    {
+        const std::uint64_t result = rotateLeft(m_state[1] * 5, 7) * 9;
+        const std::uint64_t t = m_state[1] << 17;
+
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotateLeft(m_state[3], 45);
+
+        return result;
+    }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns a pseudo random natural number in the range 0..(x-1).
+    /// Multiplying the high 32 bits of next() by x and keeping the
+    /// high 32 bits of the product avoids a slow division.
+    unsigned int nextModX(
+        unsigned int x) //< must be > 0
+    {
+        assert(x > 0);
+        return (unsigned int)(((next() >> 32) * (std::uint64_t)x) >> 32);
+    }
+};
+
+#endif // PSEUDORANDOMGENERATOR_H
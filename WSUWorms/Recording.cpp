@@ -0,0 +1,552 @@
+#include "Recording.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fcntl.h>     // For open()
+#include <sys/mman.h>  // For mmap()
+#include <sys/stat.h>  // For fstat()
+#include <unistd.h>    // For close()
+
+const char Recording::magic[8] = {'W', 'O', 'R', 'M', 'R', 'E', 'C', 'S'}; //< See documentation in header
+const std::uint32_t Recording::version;            //< See documentation in header
+const int Recording::defaultKeyframeInterval;      //< See documentation in header
+
+/// The number of encoded bytes buffered before they are written
+static const std::size_t writeBlockSize = 1 << 20;
+
+/// The number of bytes in the offset at the end of a recording
+static const std::size_t indexOffsetSize = 8;
+
+//////////////////////////////////////////////////////////////////////
+/// Appends value to bytes as a varint.
+static void appendVarint(std::vector<unsigned char> &bytes, std::uint64_t value)
+{
+    while(0x80 <= value)
+    {
+        bytes.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((unsigned char)value);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Appends value to bytes as a zigzag encoded varint.
+static void appendSignedVarint(std::vector<unsigned char> &bytes, std::int64_t value)
+{
+    appendVarint(bytes, ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63));
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Appends square s to bytes, least significant byte first.
+static void appendSquare(std::vector<unsigned char> &bytes, std::uint16_t s)
+{
+    bytes.push_back((unsigned char)(s & 0xff));
+    bytes.push_back((unsigned char)(s >> 8));
+}
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+Recording::writer::writer() :
+    m_file(nullptr),
+    m_width(0),
+    m_height(0),
+    m_keyframeInterval(defaultKeyframeInterval),
+    m_previousStep(0),
+    m_numFrames(0),
+    m_numBytesWritten(0),
+    m_hasFailed(false)
+{
+}
+
+// See documentation in header
+Recording::writer::~writer()
+{
+    close();
+}
+
+// See documentation in header
+bool Recording::writer::open(
+    const char *path,
+    int width,
+    int height,
+    int numPopulationCounts,
+    int keyframeInterval)
+{
+    assert(0 < width && 0 < height);
+    assert(0 <= numPopulationCounts && 0 < keyframeInterval);
+
+    close();
+    m_file = std::fopen(path, "wb");
+    if(nullptr == m_file)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_keyframeInterval = keyframeInterval;
+    m_squares.assign((std::size_t)width * height, 0);
+    m_changedIndexes.clear();
+    m_populationCounts.assign(numPopulationCounts, 0);
+    m_previousStep = 0;
+    m_numFrames = 0;
+    m_numBytesWritten = 0;
+    m_keyframeNumbers.clear();
+    m_keyframeOffsets.clear();
+    m_hasFailed = false;
+
+    m_bytes.clear();
+    m_bytes.reserve(writeBlockSize + 3 * m_squares.size() + 64);
+    m_bytes.insert(m_bytes.end(), magic, magic + sizeof(magic));
+    appendVarint(m_bytes, version);
+    appendVarint(m_bytes, (std::uint64_t)width);
+    appendVarint(m_bytes, (std::uint64_t)height);
+    appendVarint(m_bytes, (std::uint64_t)numPopulationCounts);
+    appendVarint(m_bytes, (std::uint64_t)keyframeInterval);
+
+    return true;
+}
+
+// See documentation in header
+bool Recording::writer::close()
+{
+    if(nullptr == m_file)
+    {   // !!!! EARLY EXIT !!!!
+        return true;
+    }
+
+    const long long indexOffset = getNumBytes();
+    m_bytes.push_back(INDEX);
+    appendVarint(m_bytes, (std::uint64_t)m_numFrames);
+    appendVarint(m_bytes, m_keyframeNumbers.size());
+    long previousNumber = 0;
+    long long previousOffset = 0;
+    for(std::size_t k = 0; k < m_keyframeNumbers.size(); ++k)
+    {
+        appendVarint(m_bytes, (std::uint64_t)(m_keyframeNumbers[k] - previousNumber));
+        appendVarint(m_bytes, (std::uint64_t)(m_keyframeOffsets[k] - previousOffset));
+        previousNumber = m_keyframeNumbers[k];
+        previousOffset = m_keyframeOffsets[k];
+    }
+    for(std::size_t b = 0; b < indexOffsetSize; ++b)
+    {
+        m_bytes.push_back((unsigned char)((std::uint64_t)indexOffset >> (8 * b)));
+    }
+
+    writeBytes();
+    m_hasFailed = 0 != std::fclose(m_file) || m_hasFailed;
+    m_file = nullptr;
+    return !m_hasFailed;
+}
+
+// See documentation in header
+void Recording::writer::finishFrame(std::int64_t step)
+{
+    assert(isOpen());
+
+    const bool isKeyframe = 0 == m_numFrames % m_keyframeInterval;
+    if(isKeyframe)
+    {
+        m_keyframeNumbers.push_back(m_numFrames);
+        m_keyframeOffsets.push_back(getNumBytes());
+    }
+
+    m_bytes.push_back(isKeyframe ? KEYFRAME : DELTA_FRAME);
+    appendSignedVarint(m_bytes, isKeyframe ? step : step - m_previousStep);
+    for(int count : m_populationCounts)
+    {
+        appendVarint(m_bytes, (std::uint64_t)std::max(0, count));
+    }
+
+    if(isKeyframe)
+    {
+        std::size_t runStart = 0;
+        for(std::size_t i = 1; i <= m_squares.size(); ++i)
+        {
+            if(i == m_squares.size() || m_squares[i] != m_squares[runStart])
+            {
+                appendVarint(m_bytes, i - runStart);
+                appendSquare(m_bytes, m_squares[runStart]);
+                runStart = i;
+            }
+        }
+    }
+    else
+    {
+        // Squares are offered in the order in which they changed, so
+        // sort them to make the gaps between indexes small
+        std::sort(m_changedIndexes.begin(), m_changedIndexes.end());
+        appendVarint(m_bytes, m_changedIndexes.size());
+        std::uint32_t nextIndex = 0;
+        for(std::uint32_t i : m_changedIndexes)
+        {
+            appendVarint(m_bytes, i - nextIndex);
+            appendSquare(m_bytes, m_squares[i]);
+            nextIndex = i + 1;
+        }
+    }
+    m_changedIndexes.clear();
+
+    m_previousStep = step;
+    m_numFrames += 1;
+    if(writeBlockSize <= m_bytes.size())
+    {
+        writeBytes();
+    }
+}
+
+// See documentation in header
+Recording::player::player(const char *path) :
+    m_mapping(nullptr),
+    m_size(0),
+    m_isValid(false),
+    m_width(0),
+    m_height(0),
+    m_keyframeInterval(0),
+    m_numFrames(0),
+    m_frameNumber(-1),
+    m_nextOffset(0),
+    m_step(0)
+{
+    const int fd = open(path, O_RDONLY);
+    if(0 > fd)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    struct stat status;
+    if(0 == fstat(fd, &status) && 0 < status.st_size)
+    {
+        void *mapping = mmap(nullptr, (std::size_t)status.st_size,
+            PROT_READ, MAP_PRIVATE, fd, 0);
+        if(MAP_FAILED != mapping)
+        {
+            m_mapping = (const unsigned char *)mapping;
+            m_size = (std::size_t)status.st_size;
+
+            // Frames are mostly read in order
+            madvise(mapping, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd); // the mapping remains valid
+
+    std::size_t offset = sizeof(magic);
+    std::uint64_t fileVersion = 0;
+    std::uint64_t width = 0;
+    std::uint64_t height = 0;
+    std::uint64_t numPopulationCounts = 0;
+    std::uint64_t keyframeInterval = 0;
+    m_isValid = nullptr != m_mapping && sizeof(magic) <= m_size &&
+        0 == std::memcmp(m_mapping, magic, sizeof(magic)) &&
+        readVarint(offset, fileVersion) && version == fileVersion &&
+        readVarint(offset, width) && readVarint(offset, height) &&
+        readVarint(offset, numPopulationCounts) &&
+        readVarint(offset, keyframeInterval) &&
+        0 < width && width <= 0x7fff && 0 < height && height <= 0x7fff &&
+        numPopulationCounts <= 0xffff &&
+        0 < keyframeInterval && keyframeInterval <= 0x7fffffff;
+    if(!m_isValid)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    m_width = (int)width;
+    m_height = (int)height;
+    m_keyframeInterval = (int)keyframeInterval;
+    m_populationCounts.assign((std::size_t)numPopulationCounts, 0);
+    m_squares.assign((std::size_t)m_width * m_height, 0);
+    m_changedSquares = PositionSet(m_width, m_height);
+    m_nextOffset = offset;
+    m_isValid = readIndex();
+}
+
+// See documentation in header
+Recording::player::~player()
+{
+    if(nullptr != m_mapping)
+    {
+        munmap((void *)m_mapping, m_size);
+    }
+}
+
+// See documentation in header
+bool Recording::player::nextFrame()
+{
+    if(!m_isValid || m_frameNumber + 1 >= m_numFrames)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    m_isValid = decodeFrameAt(m_nextOffset);
+    if(m_isValid)
+    {
+        m_frameNumber += 1;
+    }
+    return m_isValid;
+}
+
+// See documentation in header
+bool Recording::player::previousFrame()
+{
+    if(!m_isValid || 0 >= m_frameNumber)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+    if(m_undoFrames.empty())
+    {   // !!!! EARLY EXIT !!!! The current frame is a keyframe
+        return seekToFrame(m_frameNumber - 1);
+    }
+
+    const undo_frame &undo = m_undoFrames.back();
+    for(std::size_t j = m_undoIndexes.size(); j > undo.firstUndoSquare; )
+    {
+        --j;
+        const std::uint32_t i = m_undoIndexes[j];
+        m_squares[i] = m_undoSquares[j];
+        m_changedSquares.insert((int)(i % m_width), (int)(i / m_width));
+    }
+    m_undoIndexes.resize(undo.firstUndoSquare);
+    m_undoSquares.resize(undo.firstUndoSquare);
+
+    const std::size_t firstCount =
+        m_undoPopulationCounts.size() - m_populationCounts.size();
+    std::copy(m_undoPopulationCounts.begin() + firstCount,
+        m_undoPopulationCounts.end(), m_populationCounts.begin());
+    m_undoPopulationCounts.resize(firstCount);
+
+    m_step = undo.previousStep;
+    m_nextOffset = undo.offset;
+    m_frameNumber -= 1;
+    m_undoFrames.pop_back();
+
+    return true;
+}
+
+// See documentation in header
+bool Recording::player::seekToFrame(long frameNumber)
+{
+    if(!m_isValid || 0 > frameNumber || frameNumber >= m_numFrames)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    // Start from the last keyframe at or before frameNumber unless the
+    // frames that follow the current frame reach frameNumber sooner
+    const std::size_t k = (std::size_t)(std::upper_bound(
+        m_keyframeNumbers.begin(), m_keyframeNumbers.end(), frameNumber) -
+        m_keyframeNumbers.begin()) - 1;
+    if(frameNumber < m_frameNumber || m_frameNumber < m_keyframeNumbers[k])
+    {
+        m_isValid = decodeFrameAt(m_keyframeOffsets[k]);
+        m_frameNumber = m_keyframeNumbers[k];
+    }
+    while(m_isValid && m_frameNumber < frameNumber)
+    {
+        nextFrame();
+    }
+
+    return m_isValid;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Makes the buffered bytes part of the file and empties the buffer.
+/// Failures are remembered and reported by close().
+void Recording::writer::writeBytes()
+{
+    assert(nullptr != m_file);
+
+    if(m_bytes.size() != std::fwrite(m_bytes.data(), 1, m_bytes.size(), m_file))
+    {
+        m_hasFailed = true;
+    }
+    m_numBytesWritten += (long long)m_bytes.size();
+    m_bytes.clear();
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Decodes the varint at io_offset into out_value and advances
+/// io_offset past it. Returns false if the mapping ends within the
+/// varint or the varint has more than 64 bits.
+bool Recording::player::readVarint(
+    std::size_t &io_offset,
+    std::uint64_t &out_value) const
+{
+    std::uint64_t result = 0;
+    for(int shift = 0; io_offset < m_size && shift < 64; shift += 7)
+    {
+        const unsigned char byte = m_mapping[io_offset++];
+        result |= (std::uint64_t)(byte & 0x7f) << shift;
+        if(0 == (byte & 0x80))
+        {   // !!!! EARLY EXIT !!!!
+            out_value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Applies the frame at offset to the board, records which squares
+/// changed, and makes the frame's step and population current. The
+/// frame at offset must follow the current frame unless it is a
+/// keyframe. A keyframe discards what previousFrame() needs to undo
+/// earlier frames, and a delta frame adds what it needs to undo this
+/// one. Returns false if the frame is malformed.
+bool Recording::player::decodeFrameAt(std::size_t offset)
+{
+    if(offset >= m_size)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    const std::size_t frameOffset = offset;
+    const unsigned char kind = m_mapping[offset++];
+    std::uint64_t encodedStep = 0;
+    if((KEYFRAME != kind && DELTA_FRAME != kind) ||
+        !readVarint(offset, encodedStep))
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+    const std::int64_t step = (std::int64_t)(encodedStep >> 1) ^
+        -(std::int64_t)(encodedStep & 1);
+
+    const bool isUndoable = (DELTA_FRAME == kind);
+    if(isUndoable)
+    {
+        m_undoFrames.push_back({m_undoIndexes.size(), frameOffset, m_step});
+        m_undoPopulationCounts.insert(m_undoPopulationCounts.end(),
+            m_populationCounts.begin(), m_populationCounts.end());
+    }
+    else
+    {
+        m_undoFrames.clear();
+        m_undoIndexes.clear();
+        m_undoSquares.clear();
+        m_undoPopulationCounts.clear();
+    }
+
+    for(int &count : m_populationCounts)
+    {
+        std::uint64_t value = 0;
+        if(!readVarint(offset, value))
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        count = (int)std::min<std::uint64_t>(value, 0x7fffffff);
+    }
+
+    const std::size_t numSquares = m_squares.size();
+    std::uint64_t count = 0;
+    std::size_t i = 0;
+    if(DELTA_FRAME == kind && !readVarint(offset, count))
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+    for(std::uint64_t n = 0; KEYFRAME == kind ? i < numSquares : n < count; ++n)
+    {
+        std::uint64_t length = 0;
+        if(!readVarint(offset, length) || 2 > m_size - offset ||
+            numSquares - i < (KEYFRAME == kind ? length : length + 1) ||
+            (KEYFRAME == kind && 0 == length))
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        const std::uint16_t s = (std::uint16_t)(m_mapping[offset] |
+            (unsigned int)m_mapping[offset + 1] << 8);
+        offset += 2;
+
+        // A keyframe sets a run of squares, and a delta frame skips
+        // squares that did not change and sets one square
+        std::size_t end = i + (std::size_t)length;
+        if(DELTA_FRAME == kind)
+        {
+            i = end;
+            end = i + 1;
+        }
+        for(; i < end; ++i)
+        {
+            if(s != m_squares[i])
+            {
+                if(isUndoable)
+                {
+                    m_undoIndexes.push_back((std::uint32_t)i);
+                    m_undoSquares.push_back(m_squares[i]);
+                }
+                m_squares[i] = s;
+                m_changedSquares.insert((int)(i % m_width), (int)(i / m_width));
+            }
+        }
+    }
+
+    m_step = (KEYFRAME == kind) ? step : m_step + step;
+    m_nextOffset = offset;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Reads the index at the end of the recording and checks that it
+/// describes keyframes that follow the header in order, starting
+/// with frame 0, at most m_keyframeInterval frames apart. Returns
+/// false if the recording is incomplete or the index is malformed.
+bool Recording::player::readIndex()
+{
+    if(m_nextOffset + 1 + indexOffsetSize > m_size)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    std::uint64_t indexOffset = 0;
+    for(std::size_t b = 0; b < indexOffsetSize; ++b)
+    {
+        indexOffset |= (std::uint64_t)m_mapping[
+            m_size - indexOffsetSize + b] << (8 * b);
+    }
+
+    std::size_t offset = (std::size_t)indexOffset;
+    std::uint64_t numFrames = 0;
+    std::uint64_t numKeyframes = 0;
+    if(indexOffset < m_nextOffset || indexOffset >= m_size - indexOffsetSize ||
+        INDEX != m_mapping[offset++] || !readVarint(offset, numFrames) ||
+        !readVarint(offset, numKeyframes) ||
+        numFrames > 0x7fffffff || numKeyframes > numFrames ||
+        numKeyframes < (numFrames + m_keyframeInterval - 1) / m_keyframeInterval)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    m_numFrames = (long)numFrames;
+    std::uint64_t number = 0;
+    std::uint64_t keyframeOffset = 0;
+    for(std::uint64_t k = 0; k < numKeyframes; ++k)
+    {
+        std::uint64_t numberDelta = 0;
+        std::uint64_t offsetDelta = 0;
+        if(!readVarint(offset, numberDelta) || !readVarint(offset, offsetDelta))
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        number += numberDelta;
+        keyframeOffset += offsetDelta;
+        if((0 == k ? 0 != number || m_nextOffset != keyframeOffset :
+                (0 == numberDelta || (std::uint64_t)m_keyframeInterval < numberDelta ||
+                0 == offsetDelta)) ||
+            number >= numFrames || keyframeOffset >= indexOffset)
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        m_keyframeNumbers.push_back((long)number);
+        m_keyframeOffsets.push_back((std::size_t)keyframeOffset);
+    }
+
+    return offset == m_size - indexOffsetSize &&
+        (0 == numFrames || m_numFrames - m_keyframeNumbers.back() <= m_keyframeInterval);
+}
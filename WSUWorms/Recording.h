@@ -0,0 +1,306 @@
+#ifndef RECORDING_H // Guard
+#define RECORDING_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+#include "PositionSet.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// Recording defines the file format used to record what a
+/// simulation's board shows after every step so that a run can be
+/// watched again later without simulating it again. A writer records
+/// frames as a simulation runs, and a player reads them back, moving
+/// forward or backward one frame at a time or seeking to any frame.
+///
+/// A recording file starts with a header:
+/// - 8 bytes: the characters of magic
+/// - varints: the format version, the board width and height, the
+///   number of population counts in each frame, and the number of
+///   frames from one keyframe to the next
+///
+/// Frames follow in the order in which they were recorded. Each frame
+/// is:
+/// - 1 byte: KEYFRAME or DELTA_FRAME
+/// - signed varint: a KEYFRAME's step or a DELTA_FRAME's step minus
+///   the previous frame's step
+/// - varints: the population counts
+/// - a KEYFRAME stores every square as runs of equal squares: pairs
+///   of a varint run length and a square.
+/// - a DELTA_FRAME stores only the squares that changed since the
+///   previous frame: a varint number of squares and then, in order of
+///   increasing row major index, pairs of a varint gap, the index
+///   minus the previous index minus 1, and the new square.
+///
+/// The file ends with an index of the keyframes:
+/// - 1 byte: INDEX
+/// - varints: the number of frames and the number of keyframes
+/// - for each keyframe, varints: its frame number and its offset in
+///   the file minus those of the previous keyframe
+/// - 8 bytes: the offset of the INDEX byte
+///
+/// Squares are stored in 2 bytes, least significant byte first, as
+/// attribute << 8 | character. Varints are encoded as described by
+/// EventLog.
+///
+/// Design Notes:
+/// - The first frame and every keyframeInterval-th frame after it is
+/// a keyframe, so seeking to any frame decodes one keyframe and at
+/// most keyframeInterval - 1 delta frames.
+/// - Players remember the squares each delta frame since the last
+/// keyframe replaced, so stepping backward usually just restores them.
+/// Only stepping backward past a keyframe seeks to the previous frame,
+/// which decodes the keyframe before it and the delta frames between.
+/// Playing backward therefore costs about twice as much as playing
+/// forward however large the board is.
+/// - Writers keep a copy of the last recorded board and compare each
+/// square offered to it, so squares may be offered any number of
+/// times, and only squares that really changed are stored.
+/// - Players map the file into memory with mmap(), so recordings much
+/// larger than memory are streamed from disk by the operating system
+/// as they are played.
+/// - The format has no byte order or word size dependencies.
+///
+//////////////////////////////////////////////////////////////////////
+class Recording
+{
+public:
+    /// The kinds of records in a recording file
+    typedef enum
+    {
+        DELTA_FRAME,  //< A frame storing the squares that changed
+        KEYFRAME,     //< A frame storing every square
+        INDEX         //< The index of the keyframes at the end of the file
+    } record_kind;
+
+    /// The first bytes of every recording file
+    static const char magic[8];
+
+    /// The version of the format written
+    static const std::uint32_t version = 1;
+
+    /// The number of frames from one keyframe to the next used unless
+    /// another interval is requested
+    static const int defaultKeyframeInterval = 100;
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances record frames to a file as a simulation runs.
+    class writer
+    {
+    private:
+        std::FILE *m_file;                        //< The open file or nullptr
+        int m_width;                              //< Board width
+        int m_height;                             //< Board height
+        int m_keyframeInterval;                   //< See open()
+        std::vector<std::uint16_t> m_squares;     //< The board as of the current frame
+        std::vector<std::uint32_t> m_changedIndexes; //< Indexes of squares changed in the current frame
+        std::vector<int> m_populationCounts;      //< See setPopulationCount()
+        std::vector<unsigned char> m_bytes;       //< Encoded bytes not yet written
+        std::int64_t m_previousStep;              //< The step of the previous frame
+        long m_numFrames;                         //< See getNumFrames()
+        long long m_numBytesWritten;              //< Bytes written to m_file
+        std::vector<long> m_keyframeNumbers;      //< Frame number of each keyframe
+        std::vector<long long> m_keyframeOffsets; //< File offset of each keyframe
+        bool m_hasFailed;                         //< true after any write error
+
+        // See documentation in implementation file
+        void writeBytes();
+
+    public:
+        //////////////////////////////////////////////////////////////
+        /// Constructs a writer that is not open.
+        writer();
+
+        /// Closes the recording
+        ~writer();
+
+        writer(const writer &) = delete;
+        writer &operator=(const writer &) = delete;
+
+        /// @name Non-mutating Accessors
+        /// @{
+        bool isOpen() const { return nullptr != m_file; }
+
+        /// Returns the number of frames recorded since the writer was opened
+        long getNumFrames() const { return m_numFrames; }
+
+        //////////////////////////////////////////////////////////////
+        /// Returns the number of bytes recorded including bytes not
+        /// yet written to the file.
+        long long getNumBytes() const {
+            return m_numBytesWritten + (long long)m_bytes.size(); }
+        /// @}
+
+        /// @name Functions that mutate the writer
+        /// @{
+
+        //////////////////////////////////////////////////////////////
+        /// Closes any open file, creates a new file at path replacing
+        /// any existing file, and writes a header for a board with
+        /// width columns and height rows and frames with
+        /// numPopulationCounts population counts. Every
+        /// keyframeInterval-th frame is a keyframe. Returns false if
+        /// the file could not be created.
+        bool open(
+            const char *path,
+            int width,                //< > 0
+            int height,               //< > 0
+            int numPopulationCounts,  //< >= 0
+            int keyframeInterval);    //< > 0
+
+        //////////////////////////////////////////////////////////////
+        /// Writes any buffered frames and the index and closes the
+        /// file. Returns false if any part of the recording could not
+        /// be written. Does nothing and returns true if the writer is
+        /// not open.
+        bool close();
+
+        //////////////////////////////////////////////////////////////
+        /// Offers the square at {x,y} with character c and attribute
+        /// attr (0..255) for the current frame. The square is stored
+        /// only if it differs from the square at {x,y} in the previous
+        /// frame. Squares that have never been offered are 0.
+        void offerSquare(int x, int y, char c, int attr)
+        {
+            const std::uint32_t i = (std::uint32_t)y * m_width + x;
+            const std::uint16_t s =
+                (std::uint16_t)((unsigned int)attr << 8 | (unsigned char)c);
+            if(s != m_squares[i])
+            {
+                m_squares[i] = s;
+                m_changedIndexes.push_back(i);
+            }
+        }
+
+        /// Sets the population count at index i for the current frame
+        void setPopulationCount(int i, int count) {
+            m_populationCounts[i] = count; }
+
+        //////////////////////////////////////////////////////////////
+        /// Encodes the current frame, which shows the board after step
+        /// step, and starts the next frame. Frames are written to the
+        /// file in large blocks.
+        void finishFrame(std::int64_t step);
+        /// @}
+    };
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances map a recording file into memory and reconstruct the
+    /// board shown by any of its frames.
+    class player
+    {
+    private:
+        const unsigned char *m_mapping;    //< The mapped file or nullptr
+        std::size_t m_size;                //< Number of bytes mapped
+        bool m_isValid;                    //< false after any failure
+        int m_width;                       //< Board width
+        int m_height;                      //< Board height
+        int m_keyframeInterval;            //< See getKeyframeInterval()
+        long m_numFrames;                  //< See getNumFrames()
+        std::vector<long> m_keyframeNumbers;        //< Frame number of each keyframe
+        std::vector<std::size_t> m_keyframeOffsets; //< File offset of each keyframe
+        long m_frameNumber;                //< See getFrameNumber()
+        std::size_t m_nextOffset;          //< Offset of the frame after the current one
+        std::int64_t m_step;               //< See getStep()
+        std::vector<int> m_populationCounts; //< See getPopulationCount()
+        std::vector<std::uint16_t> m_squares; //< The board shown by the current frame
+        PositionSet m_changedSquares;      //< See getChangedSquares()
+
+        /// What previousFrame() needs to restore to undo one delta frame
+        typedef struct
+        {
+            std::size_t firstUndoSquare; //< Index of the frame's first undo square
+            std::size_t offset;          //< Offset of the frame in the file
+            std::int64_t previousStep;   //< The step before the frame
+        } undo_frame;
+
+        /// One entry for each delta frame decoded since the last
+        /// keyframe, so the last entry undoes the current frame
+        std::vector<undo_frame> m_undoFrames;
+        std::vector<std::uint32_t> m_undoIndexes; //< Index of each square changed
+        std::vector<std::uint16_t> m_undoSquares; //< The square before it changed
+        std::vector<int> m_undoPopulationCounts;  //< Population counts before each frame
+
+        // See documentation in implementation file
+        bool readVarint(std::size_t &io_offset, std::uint64_t &out_value) const;
+
+        // See documentation in implementation file
+        bool decodeFrameAt(std::size_t offset);
+
+        // See documentation in implementation file
+        bool readIndex();
+
+    public:
+        //////////////////////////////////////////////////////////////
+        /// Maps the file at path and reads its header and index. The
+        /// player is invalid if the file cannot be mapped or is not a
+        /// complete recording of this version. Before the first call
+        /// to nextFrame() or seekToFrame(), the board is blank and
+        /// getFrameNumber() returns -1.
+        explicit player(const char *path);
+
+        /// Unmaps the file
+        ~player();
+
+        player(const player &) = delete;
+        player &operator=(const player &) = delete;
+
+        /// @name Non-mutating Accessors
+        /// @{
+
+        //////////////////////////////////////////////////////////////
+        /// Returns true iff the file is a recording and every frame
+        /// decoded so far was well formed.
+        bool isValid() const { return m_isValid; }
+        int getWidth() const { return m_width; }
+        int getHeight() const { return m_height; }
+        long getNumFrames() const { return m_numFrames; }
+        int getKeyframeInterval() const { return m_keyframeInterval; }
+
+        /// Returns the number of the current frame or -1 before the first
+        long getFrameNumber() const { return m_frameNumber; }
+
+        /// Returns the simulation step after which the current frame was recorded
+        std::int64_t getStep() const { return m_step; }
+        int getNumPopulationCounts() const { return (int)m_populationCounts.size(); }
+        int getPopulationCount(int i) const { return m_populationCounts[i]; }
+        char getOnecAt(int x, int y) const {
+            return (char)(m_squares[(std::size_t)y * m_width + x] & 0xff); }
+        int getAttrAt(int x, int y) const {
+            return m_squares[(std::size_t)y * m_width + x] >> 8; }
+
+        //////////////////////////////////////////////////////////////
+        /// Returns the squares whose contents may have changed since
+        /// the last call to clearChangedSquares().
+        const PositionSet &getChangedSquares() const { return m_changedSquares; }
+        /// @}
+
+        /// @name Functions that mutate the player
+        /// @{
+
+        //////////////////////////////////////////////////////////////
+        /// Makes the frame after the current one current. Returns false
+        /// if there is no such frame or it is malformed.
+        bool nextFrame();
+
+        //////////////////////////////////////////////////////////////
+        /// Makes the frame before the current one current. Returns
+        /// false if there is no such frame or it is malformed.
+        bool previousFrame();
+
+        //////////////////////////////////////////////////////////////
+        /// Makes frame frameNumber current by decoding the closest
+        /// keyframe at or before it and the delta frames that follow.
+        /// Returns false if frameNumber is not a frame of the
+        /// recording or any frame decoded is malformed.
+        bool seekToFrame(long frameNumber);
+
+        /// Call after presenting the changed squares to users
+        void clearChangedSquares() { m_changedSquares.clear(); }
+        /// @}
+    };
+};
+
+#endif // RECORDING_H
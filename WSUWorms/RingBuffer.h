@@ -0,0 +1,102 @@
+#ifndef RINGBUFFER_H // Guard
+#define RINGBUFFER_H
+
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+
+//////////////////////////////////////////////////////////////////////
+/// RingBuffer stores the most recent elements appended to it, up to a
+/// capacity fixed at construction. Appending to a full buffer replaces
+/// the oldest element. Elements are accessed in the order in which
+/// they were appended, oldest first.
+///
+/// Design Notes:
+/// - Storage for every element is allocated when the buffer is
+/// constructed, so appending never allocates memory. This makes ring
+/// buffers suitable for recording a value during every simulation
+/// step.
+/// - RingBuffer is a class template for the same reason as Board: the
+/// same logic serves any type of element.
+///
+//////////////////////////////////////////////////////////////////////
+template <typename T>
+class RingBuffer
+{
+private:
+    std::vector<T> m_elements; //< capacity() elements, some unused
+    std::size_t m_first;       //< Index in m_elements of the oldest element
+    std::size_t m_size;        //< Number of elements stored
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a buffer with capacity 0 that stores nothing.
+    RingBuffer() : m_first(0), m_size(0) {}
+
+    //////////////////////////////////////////////////////////////////
+    /// Constructs an empty buffer that stores up to capacity elements.
+    explicit RingBuffer(
+        std::size_t capacity) : //< The maximum number of elements stored
+        m_elements(capacity), m_first(0), m_size(0) {}
+
+    /// @name Non-mutating Accessors
+    /// @{
+    std::size_t capacity() const { return m_elements.size(); }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return 0 == m_size; }
+    bool full() const { return m_elements.size() == m_size; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the element appended i elements after the oldest
+    /// element stored.
+    const T &operator[](
+        std::size_t i) const //< must be < size()
+    {
+        assert(i < m_size);
+        const std::size_t offset = m_first + i;
+        return m_elements[(offset < m_elements.size()) ?
+            offset : offset - m_elements.size()];
+    }
+
+    /// Returns the most recently appended element. The buffer must
+    /// not be empty.
+    const T &back() const { return (*this)[m_size - 1]; }
+    /// @}
+
+    /// @name Functions that mutate the buffer
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends a copy of value, replacing the oldest element if the
+    /// buffer is full. Does nothing if capacity() is 0.
+    void push_back(const T &value)
+    {
+        if(m_elements.empty())
+        {   // !!!! EARLY EXIT !!!!
+            return;
+        }
+
+        std::size_t offset = m_first + m_size;
+        if(offset >= m_elements.size())
+        {
+            offset -= m_elements.size();
+        }
+        m_elements[offset] = value;
+
+        if(full())
+        {
+            m_first = (m_first + 1 < m_elements.size()) ? m_first + 1 : 0;
+        }
+        else
+        {
+            m_size += 1;
+        }
+    }
+
+    /// Discards every element without changing capacity()
+    void clear() { m_first = 0; m_size = 0; }
+    /// @}
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,96 @@
+#include "SegmentPool.h"
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+SegmentPool::SegmentPool() :
+    m_extent(0),
+    m_statistics()
+{
+}
+
+// See documentation in header
+std::uint32_t SegmentPool::capacityFor(std::uint32_t minimumCapacity)
+{
+    std::uint32_t capacity = 1;
+    while(capacity < minimumCapacity) { capacity <<= 1; }
+    return capacity;
+}
+
+// See documentation in header
+std::uint32_t SegmentPool::allocate(std::uint32_t capacity)
+{
+    assert(capacityFor(capacity) == capacity);
+
+    const int sizeClassIndex = sizeClassOf(capacity);
+    if(sizeClassIndex >= (int)m_sizeClasses.size())
+    {
+        m_sizeClasses.resize(sizeClassIndex + 1, size_class());
+    }
+
+    std::uint32_t result;
+    size_class &sizeClass(m_sizeClasses[sizeClassIndex]);
+    if(sizeClass.freeBlocks.empty())
+    {
+        result = m_extent;
+        m_extent += capacity;
+        sizeClass.numBlocks += 1;
+        if(sizeClass.freeBlocks.capacity() < sizeClass.numBlocks)
+        {
+            sizeClass.freeBlocks.reserve(2 * sizeClass.numBlocks);
+        }
+    }
+    else
+    {
+        result = sizeClass.freeBlocks.back();
+        sizeClass.freeBlocks.pop_back();
+        m_statistics.numReuses += 1;
+    }
+    m_statistics.numAllocations += 1;
+
+    assert(result + capacity <= m_extent);
+    return result;
+}
+
+// See documentation in header
+void SegmentPool::release(std::uint32_t offset, std::uint32_t capacity)
+{
+    assert(offset + capacity <= m_extent);
+
+    size_class &sizeClass(m_sizeClasses[sizeClassOf(capacity)]);
+    assert(sizeClass.freeBlocks.size() < sizeClass.numBlocks);
+    
+    sizeClass.freeBlocks.push_back(offset);
+    m_statistics.numReleases += 1;
+}
+
+// See documentation in header
+void SegmentPool::reset()
+{
+    for(size_class &sizeClass : m_sizeClasses)
+    {
+        sizeClass.freeBlocks.clear();
+        sizeClass.numBlocks = 0;
+    }
+    m_extent = 0;
+    m_statistics.numResets += 1;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the base 2 logarithm of capacity which must be a power of
+/// 2.
+int SegmentPool::sizeClassOf(std::uint32_t capacity)
+{
+    assert(0 < capacity && 0 == (capacity & (capacity - 1)));
+
+    int result = 0;
+    while((std::uint32_t)1 << result < capacity) { ++result; }
+    return result;
+}
@@ -0,0 +1,99 @@
+#ifndef SEGMENTPOOL_H // Guard
+#define SEGMENTPOOL_H
+
+#include <cstdint>
+#include <vector>
+#include <cassert>
+
+
+//////////////////////////////////////////////////////////////////////
+/// SegmentPool hands out blocks of element offsets within arrays of
+/// segment storage owned by someone else e.g. WormStore. Every block
+/// has a power of 2 capacity. Released blocks are kept in one free
+/// list per capacity ("size class") and are handed out again before
+/// any new offsets are used.
+///
+/// Design Notes:
+/// - The pool only does arithmetic on offsets. It never allocates or
+/// touches segment storage itself, so the owner decides how and when
+/// storage grows. The owner must keep at least getExtent() elements
+/// of storage.
+/// - reset() makes every offset available again in one operation
+/// independent of the number of blocks, like resetting an arena.
+/// - The pool counts what it does so that callers can verify that
+/// steady state simulation steps reuse blocks instead of growing
+/// storage. The pool itself allocates heap memory only when its
+/// extent grows: each free list reserves room for every block of its
+/// size class before any of them can be released.
+///
+//////////////////////////////////////////////////////////////////////
+class SegmentPool
+{
+public:
+    /// Counts of operations performed since the pool was created
+    struct statistics
+    {
+        long numAllocations;   //< Blocks handed out
+        long numReuses;        //< Blocks handed out from free lists
+        long numReleases;      //< Blocks released
+        long numResets;        //< Calls to reset()
+    };
+
+private:
+    /// The blocks with one capacity
+    struct size_class
+    {
+        std::vector<std::uint32_t> freeBlocks; //< Offsets of released blocks
+        std::uint32_t numBlocks;  //< Blocks handed out since the most recent reset excluding reuses
+    };
+    
+    /// Size classes indexed by the base 2 logarithm of their capacity
+    std::vector<size_class> m_sizeClasses;
+
+    /// Offsets >= m_extent have never been handed out since the most
+    /// recent reset
+    std::uint32_t m_extent;
+
+    /// See getStatistics()
+    statistics m_statistics;
+
+    // See documentation in implementation file
+    static int sizeClassOf(std::uint32_t capacity);
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a pool that has never handed out any offsets.
+    SegmentPool();
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the smallest block capacity that is >= minimumCapacity.
+    static std::uint32_t capacityFor(std::uint32_t minimumCapacity);
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the offset of a block with the specified capacity,
+    /// which must be a value returned by capacityFor(). The block is
+    /// disjoint from every other block that has not been released.
+    std::uint32_t allocate(std::uint32_t capacity);
+
+    //////////////////////////////////////////////////////////////////
+    /// Makes the block at offset with the specified capacity available
+    /// to later calls to allocate(). The block must have been returned
+    /// by allocate() with the same capacity since the most recent
+    /// reset and must not already be released.
+    void release(std::uint32_t offset, std::uint32_t capacity);
+
+    //////////////////////////////////////////////////////////////////
+    /// Releases every block at once. Memory used by the free lists is
+    /// retained for reuse.
+    void reset();
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns one more than the largest offset in any block handed
+    /// out since the most recent reset.
+    std::uint32_t getExtent() const { return m_extent; }
+
+    /// Returns counts of the operations performed by the pool
+    const statistics &getStatistics() const { return m_statistics; }
+};
+
+#endif // SEGMENTPOOL_H
@@ -0,0 +1,109 @@
+#include "SimulationBatch.h"
+#include "WormsSim.h"
+#include "HeadlessWormsSimUIStrategy.h"
+#include "WorkStealingThreadPool.h"
+#include <algorithm>
+#include <chrono>
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+std::vector<SimulationBatch::result> SimulationBatch::run(
+    const std::vector<configuration> &configs,
+    int numThreads)
+{
+    std::vector<result> results(configs.size());
+    
+    {
+        WorkStealingThreadPool pool(numThreads);
+        for(std::size_t i = 0; i < configs.size(); ++i)
+        {
+            // Each task writes only its own element of results
+            result *resultPtr = &results[i];
+            const configuration *configPtr = &configs[i];
+            pool.submit([resultPtr, configPtr] {
+                *resultPtr = runOne(*configPtr); });
+        }
+        pool.waitUntilIdle();
+    }
+    
+    assert(results.size() == configs.size());
+    return results;
+}
+
+// See documentation in header
+SimulationBatch::result SimulationBatch::runOne(const configuration &config)
+{
+    assert(0 < config.maxNumberOfSteps);
+    
+    const auto start = std::chrono::steady_clock::now();
+    
+    WormsSim sim(config.width, config.height, (nullptr != config.species) ?
+        *config.species : SpeciesRegistry::getDefault());
+    sim.seedRandomNumbers(config.seed);
+    sim.setCarrotRegrowthRate(config.carrotRegrowthRate);
+    HeadlessWormsSimUIStrategy uiStrategy(sim, config.maxNumberOfSteps,
+        config.stopsAtExtinction);
+    sim.runSimulation(uiStrategy, config.numWorms);
+    
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    
+    result r;
+    r.config = config;
+    for(int i = 0; i < sim.getPopulation().getNumSpecies(); ++i)
+    {
+        r.populations.push_back(sim.getPopulation().getCount(i));
+    }
+    r.highWaterMark = sim.getHighWaterMark();
+    r.numCarrots = sim.getNumCarrots();
+    r.numberOfSteps = uiStrategy.getNumberOfSteps();
+    r.extinctionStep = uiStrategy.getExtinctionStep();
+    r.boardChecksum = sim.computeBoardChecksum();
+    r.seconds = elapsed.count();
+    
+    return r;
+}
+
+// See documentation in header
+void SimulationBatch::writeResultTable(
+    std::FILE *file,
+    const std::vector<result> &results)
+{
+    std::size_t maxNumSpecies = 0;
+    for(const result &r : results)
+    {
+        maxNumSpecies = std::max(maxNumSpecies, r.populations.size());
+    }
+    
+    std::fprintf(file, "run,width,height,worms,max_steps,seed,carrot_regrowth,"
+        "species,hi_water_mark,carrots,steps,extinction_step,board_checksum,"
+        "seconds");
+    for(std::size_t i = 0; i < maxNumSpecies; ++i)
+    {
+        std::fprintf(file, ",population_%lu", (unsigned long)i);
+    }
+    std::fprintf(file, "\n");
+    
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const result &r(results[i]);
+        const SpeciesRegistry &species((nullptr != r.config.species) ?
+            *r.config.species : SpeciesRegistry::getDefault());
+        std::fprintf(file, "%lu,%d,%d,%d,%ld,%llu,%g,%s,%d,%ld,%ld,%ld,"
+            "%016llx,%.6f",
+            (unsigned long)i, r.config.width, r.config.height,
+            r.config.numWorms, r.config.maxNumberOfSteps,
+            (unsigned long long)r.config.seed, r.config.carrotRegrowthRate,
+            species.getName().c_str(),
+            r.highWaterMark, r.numCarrots, r.numberOfSteps, r.extinctionStep,
+            (unsigned long long)r.boardChecksum, r.seconds);
+        for(int count : r.populations)
+        {
+            std::fprintf(file, ",%d", count);
+        }
+        std::fprintf(file, "\n");
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SIMULATIONBATCH_H // Guard
+#define SIMULATIONBATCH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+class SpeciesRegistry;
+
+
+//////////////////////////////////////////////////////////////////////
+/// SimulationBatch runs many independent headless simulations in
+/// parallel and collects statistics about each run in a table.
+///
+/// Each configuration in a batch describes one simulation run. Runs
+/// are executed by a WorkStealingThreadPool with one worker per
+/// hardware thread by default. Because every WormsSim instance is
+/// independent and has its own pseudo random number generator, runs
+/// do not share any mutable state, throughput scales with the number
+/// of cores, and the result of each run depends only on its
+/// configuration.
+///
+//////////////////////////////////////////////////////////////////////
+class SimulationBatch
+{
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this structure describe one simulation run.
+    struct configuration
+    {
+        int width;               //< Board width in squares
+        int height;              //< Board height in squares
+        int numWorms;            //< Initial number of worms
+        long maxNumberOfSteps;   //< Number of steps to run (must be > 0)
+        std::uint64_t seed;      //< Pseudo random number seed
+        bool stopsAtExtinction;  //< == true iff the run ends when all worms are dead
+        double carrotRegrowthRate; //< See WormsSim::setCarrotRegrowthRate()
+        
+        /// The species of the worms or nullptr for the default species.
+        /// Runs may share a registry. See SpeciesRegistry.
+        const SpeciesRegistry *species;
+    };
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this structure store statistics about one
+    /// completed simulation run.
+    struct result
+    {
+        configuration config;    //< The configuration of the run
+        std::vector<int> populations; //< Living worms of each species at the end
+        int highWaterMark;       //< Maximum simultaneous worms
+        long numCarrots;         //< Squares containing carrots at the end
+        long numberOfSteps;      //< Number of steps actually run
+        long extinctionStep;     //< Step when all worms were dead or -1
+        std::uint64_t boardChecksum; //< See WormsSim::computeBoardChecksum()
+        double seconds;          //< Wall clock duration of the run
+    };
+
+    //////////////////////////////////////////////////////////////////
+    /// Runs a simulation for each of configs using numThreads worker
+    /// threads or one thread per hardware thread if numThreads is
+    /// <= 0. Returns one result per configuration in the same order
+    /// as configs. This function returns after every run completes.
+    static std::vector<result> run(
+        const std::vector<configuration> &configs,
+        int numThreads = 0);
+
+    //////////////////////////////////////////////////////////////////
+    /// Runs the single simulation described by config on the calling
+    /// thread and returns its result.
+    static result runOne(const configuration &config);
+
+    //////////////////////////////////////////////////////////////////
+    /// Writes results to file as a table of comma separated values
+    /// with one header row followed by one row per result. Each row
+    /// names the species registry of its run and ends with the
+    /// populations of the run's species in registry order, so rows of
+    /// runs with fewer species than others have fewer columns.
+    static void writeResultTable(
+        std::FILE *file,
+        const std::vector<result> &results);
+};
+
+#endif // SIMULATIONBATCH_H
@@ -0,0 +1,131 @@
+#include "Snapshot.h"
+#include <fcntl.h>     // For open()
+#include <sys/mman.h>  // For mmap()
+#include <sys/stat.h>  // For fstat()
+#include <unistd.h>    // For write() and close()
+
+const char Snapshot::magic[8] = {'W', 'O', 'R', 'M', 'S', 'N', 'A', 'P'}; //< See documentation in header
+const std::uint32_t Snapshot::version;       //< See documentation in header
+const std::uint32_t Snapshot::byteOrderMark; //< See documentation in header
+
+/// The offset of the file size within the header
+static const std::size_t fileSizeOffset =
+    sizeof(Snapshot::magic) + 2 * sizeof(std::uint32_t);
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+Snapshot::writer::writer()
+{
+    std::memcpy(extend(sizeof(magic)), magic, sizeof(magic));
+    write(version);
+    write(byteOrderMark);
+    write((std::uint64_t)0); // replaced by writeToFile()
+}
+
+// See documentation in header
+bool Snapshot::writer::writeToFile(const char *path)
+{
+    const std::uint64_t fileSize = m_bytes.size();
+    std::memcpy(m_bytes.data() + fileSizeOffset, &fileSize, sizeof(fileSize));
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(0 > fd)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    // write() may write fewer bytes than requested e.g. when
+    // interrupted, in which case the rest is written by another call
+    std::size_t numWritten = 0;
+    while(numWritten < m_bytes.size())
+    {
+        const ssize_t result = ::write(fd, m_bytes.data() + numWritten,
+            m_bytes.size() - numWritten);
+        if(0 >= result)
+        {
+            break;
+        }
+        numWritten += (std::size_t)result;
+    }
+
+    return 0 == close(fd) && numWritten == m_bytes.size();
+}
+
+// See documentation in header
+Snapshot::reader::reader(const char *path) :
+    m_mapping(nullptr),
+    m_size(0),
+    m_offset(0),
+    m_isValid(false)
+{
+    const int fd = open(path, O_RDONLY);
+    if(0 > fd)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    struct stat status;
+    if(0 == fstat(fd, &status) && 0 < status.st_size)
+    {
+        void *mapping = mmap(nullptr, (std::size_t)status.st_size,
+            PROT_READ, MAP_PRIVATE, fd, 0);
+        if(MAP_FAILED != mapping)
+        {
+            m_mapping = mapping;
+            m_size = (std::size_t)status.st_size;
+            m_isValid = true;
+
+            // The whole file is about to be read in order
+            madvise(m_mapping, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    close(fd); // the mapping remains valid
+
+    char fileMagic[sizeof(magic)] = {};
+    const char *bytes = consume(sizeof(fileMagic));
+    if(nullptr != bytes) { std::memcpy(fileMagic, bytes, sizeof(fileMagic)); }
+
+    std::uint32_t fileVersion = 0;
+    std::uint32_t fileByteOrderMark = 0;
+    std::uint64_t fileSize = 0;
+    read(fileVersion);
+    read(fileByteOrderMark);
+    read(fileSize);
+    if(0 != std::memcmp(fileMagic, magic, sizeof(magic)) ||
+        version != fileVersion || byteOrderMark != fileByteOrderMark ||
+        m_size != fileSize)
+    {
+        fail();
+    }
+}
+
+// See documentation in header
+Snapshot::reader::~reader()
+{
+    if(nullptr != m_mapping)
+    {
+        munmap(m_mapping, m_size);
+    }
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+const char *Snapshot::reader::consume(std::size_t numBytes)
+{
+    if(!m_isValid || numBytes > m_size - m_offset)
+    {   // !!!! EARLY EXIT !!!!
+        fail();
+        return nullptr;
+    }
+
+    const char *result = (const char *)m_mapping + m_offset;
+    m_offset += numBytes;
+    return result;
+}
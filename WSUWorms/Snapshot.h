@@ -0,0 +1,209 @@
+#ifndef SNAPSHOT_H // Guard
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <type_traits>
+
+
+//////////////////////////////////////////////////////////////////////
+/// Snapshot defines the binary file format used to save and restore
+/// the complete state of a simulation. A snapshot file is a header
+/// followed by the state of each part of the simulation in a fixed
+/// order. Each part writes itself with a writer and reads itself back
+/// with a reader, so only the part that owns some state knows how
+/// that state is stored.
+///
+/// The header contains:
+/// - 8 bytes: the characters of magic
+/// - 4 bytes: the format version
+/// - 4 bytes: byteOrderMark in the byte order of the writer
+/// - 8 bytes: the number of bytes in the file
+///
+/// Values are stored in the writer's native byte order and sizes.
+/// Arrays are stored as an 8 byte element count followed by the
+/// elements exactly as they are laid out in memory.
+///
+/// Design Notes:
+/// - A writer accumulates the whole snapshot in memory and writes the
+/// file with a single call to write(), and a reader maps the file
+/// into memory with mmap() and copies arrays out of the mapping with
+/// memcpy(). Neither converts one value at a time, so saving and
+/// restoring large simulations is limited by memory bandwidth.
+/// - A snapshot written by a machine with a different byte order or
+/// by a different version of the format is rejected rather than
+/// converted.
+/// - Readers never read past the end of the mapping. Once any read
+/// fails, every later read fails, so a sequence of reads can be
+/// checked once at the end.
+///
+//////////////////////////////////////////////////////////////////////
+class Snapshot
+{
+public:
+    /// The first bytes of every snapshot file
+    static const char magic[8];
+
+    /// The version of the format written. Increment the version
+    /// whenever the state written by any part of the simulation
+    /// changes.
+    static const std::uint32_t version = 3;
+
+    /// A value whose bytes reveal the byte order of the writer
+    static const std::uint32_t byteOrderMark = 0x01020304;
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances accumulate a snapshot in memory and then write it to
+    /// a file.
+    class writer
+    {
+    private:
+        std::vector<char> m_bytes; //< The header and everything written
+
+    public:
+        //////////////////////////////////////////////////////////////
+        /// Constructs a writer containing only a header.
+        writer();
+
+        /// Returns the number of bytes written so far including the header
+        std::size_t size() const { return m_bytes.size(); }
+
+        //////////////////////////////////////////////////////////////
+        /// Makes room for a snapshot of numBytes bytes so that writing
+        /// up to that many bytes does not move the bytes already
+        /// written.
+        void reserve(std::size_t numBytes) { m_bytes.reserve(numBytes); }
+
+        //////////////////////////////////////////////////////////////
+        /// Appends numBytes bytes and returns a pointer to the first
+        /// of them. The pointer is invalidated by the next call to any
+        /// function that writes.
+        char *extend(std::size_t numBytes)
+        {
+            const std::size_t oldSize = m_bytes.size();
+            m_bytes.resize(oldSize + numBytes);
+            return m_bytes.data() + oldSize;
+        }
+
+        /// Appends the bytes of value
+        template <typename T>
+        void write(const T &value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable values can be written");
+            std::memcpy(extend(sizeof(T)), &value, sizeof(T));
+        }
+
+        /// Appends an element count followed by count elements
+        template <typename T>
+        void writeArray(const T *elements, std::size_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable elements can be written");
+            write((std::uint64_t)count);
+            if(0 < count)
+            {
+                std::memcpy(extend(count * sizeof(T)), elements,
+                    count * sizeof(T));
+            }
+        }
+
+        /// Appends the size of elements followed by its elements
+        template <typename T>
+        void writeVector(const std::vector<T> &elements)
+        {
+            writeArray(elements.data(), elements.size());
+        }
+
+        //////////////////////////////////////////////////////////////
+        /// Stores the final size in the header and writes the snapshot
+        /// to a new file at path, replacing any existing file. Returns
+        /// false if the file could not be written completely.
+        bool writeToFile(const char *path);
+    };
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances map a snapshot file into memory and read it in the
+    /// order in which it was written.
+    class reader
+    {
+    private:
+        void *m_mapping;          //< The mapped file or nullptr
+        std::size_t m_size;       //< Number of bytes mapped
+        std::size_t m_offset;     //< Offset of the next byte to read
+        bool m_isValid;           //< false after any failure
+
+        /// Returns a pointer to the next numBytes bytes and advances
+        /// past them or returns nullptr and fails if there are fewer
+        const char *consume(std::size_t numBytes);
+
+    public:
+        //////////////////////////////////////////////////////////////
+        /// Maps the file at path and reads its header. The reader is
+        /// invalid if the file cannot be mapped or does not start with
+        /// a header written by this version on a machine with the same
+        /// byte order.
+        explicit reader(const char *path);
+
+        /// Unmaps the file
+        ~reader();
+
+        reader(const reader &) = delete;
+        reader &operator=(const reader &) = delete;
+
+        //////////////////////////////////////////////////////////////
+        /// Returns true iff every read so far has succeeded.
+        bool isValid() const { return m_isValid; }
+
+        //////////////////////////////////////////////////////////////
+        /// Returns true iff the reader is valid and every byte of the
+        /// file has been read.
+        bool isAtEnd() const { return m_isValid && m_offset == m_size; }
+
+        //////////////////////////////////////////////////////////////
+        /// Makes the reader invalid e.g. because the values read are
+        /// inconsistent with each other.
+        void fail() { m_isValid = false; }
+
+        /// Reads a value written by writer::write(). Returns isValid().
+        template <typename T>
+        bool read(T &out_value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable values can be read");
+            const char *bytes = consume(sizeof(T));
+            if(nullptr != bytes) { std::memcpy(&out_value, bytes, sizeof(T)); }
+            return m_isValid;
+        }
+
+        //////////////////////////////////////////////////////////////
+        /// Reads an array written by writer::writeArray() or
+        /// writer::writeVector() into out_elements. Fails if the array
+        /// has more than maxCount elements. Returns isValid().
+        template <typename T>
+        bool readVector(std::vector<T> &out_elements, std::size_t maxCount)
+        {
+            static_assert(std::is_trivially_copyable<T>::value,
+                "only trivially copyable elements can be read");
+            std::uint64_t count = 0;
+            if(!read(count) || count > maxCount ||
+                count > (m_size - m_offset) / sizeof(T))
+            {   // !!!! EARLY EXIT !!!!
+                fail();
+                return false;
+            }
+            out_elements.resize((std::size_t)count);
+            const char *bytes = consume((std::size_t)count * sizeof(T));
+            if(0 < count && nullptr != bytes)
+            {
+                std::memcpy(out_elements.data(), bytes,
+                    (std::size_t)count * sizeof(T));
+            }
+            return m_isValid;
+        }
+    };
+};
+
+#endif // SNAPSHOT_H
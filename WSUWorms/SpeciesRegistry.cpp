@@ -0,0 +1,277 @@
+#include "SpeciesRegistry.h"
+#include "Worm.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+const int SpeciesRegistry::maxNumSpecies; //< See documentation in header
+const int SpeciesRegistry::remainsAttr;   //< See documentation in header
+const int SpeciesRegistry::maxAttr;       //< See documentation in header
+
+/// The largest capacity or food value a species may have
+static const int maxFoodAmount = 1000;
+
+//////////////////////////////////////////////////////////////////////
+/// Stores the int following prefix at the start of token in
+/// out_value. Returns false if token does not start with prefix or
+/// the rest of token is not an int.
+static bool parseIntField(
+    const std::string &token, const char *prefix, int &out_value)
+{
+    const std::string::size_type prefixLength = std::string(prefix).size();
+    if(0 != token.compare(0, prefixLength, prefix) ||
+        token.size() == prefixLength)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    const char *start = token.c_str() + prefixLength;
+    char *end = nullptr;
+    const long value = std::strtol(start, &end, 10);
+    out_value = (int)value;
+    return '\0' == *end && (long)out_value == value;
+}
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+SpeciesRegistry::SpeciesRegistry(const std::string &name) :
+    m_name(name)
+{
+}
+
+// See documentation in header
+const SpeciesRegistry &SpeciesRegistry::getDefault()
+{
+    static const SpeciesRegistry result = []()
+    {
+        SpeciesRegistry registry("default");
+        registry.add("Vegetarian", 1, 3, 3, GRAZES);
+        registry.add("Scissor-head", 2, 4, 5, SLICES | GRAZES);
+        registry.add("Cannibal", 3, 5, 4, CANNIBALIZES | GRAZES);
+        return registry;
+    }();
+
+    return result;
+}
+
+// See documentation in header
+bool SpeciesRegistry::parseBehaviors(
+    const std::string &text,
+    unsigned int &out_behaviors)
+{
+    out_behaviors = 0;
+
+    std::istringstream names(text);
+    std::string name;
+    bool result = !text.empty();
+    while(result && std::getline(names, name, ','))
+    {
+        if("slice" == name) { out_behaviors |= SLICES; }
+        else if("cannibalize" == name) { out_behaviors |= CANNIBALIZES; }
+        else if("carrots" == name) { out_behaviors |= GRAZES; }
+        else { result = ("nothing" == name); }
+    }
+
+    return result;
+}
+
+// See documentation in header
+int SpeciesRegistry::find(const std::string &name) const
+{
+    for(const species &s : m_species)
+    {
+        if(s.m_name == name)
+        {   // !!!! EARLY EXIT !!!!
+            return s.m_index;
+        }
+    }
+
+    return -1;
+}
+
+// See documentation in header
+bool SpeciesRegistry::add(
+    const std::string &name,
+    int attr,
+    int capacity,
+    int foodValue,
+    unsigned int behaviors)
+{
+    if(size() >= maxNumSpecies ||
+        name.empty() ||
+        std::string::npos != name.find_first_of(" \t\r\n#") ||
+        -1 != find(name) ||
+        1 > attr || attr > maxAttr || remainsAttr == attr ||
+        1 > capacity || capacity > maxFoodAmount ||
+        0 > foodValue || foodValue > maxFoodAmount ||
+        ALL_BEHAVIORS < behaviors)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    species added;
+    added.m_name = name;
+    added.m_attr = attr;
+    added.m_capacity = capacity;
+    added.m_foodValue = foodValue;
+    added.m_behaviors = behaviors;
+    added.m_index = size();
+    Worm::composeEatFunctions(added);
+    m_species.push_back(added);
+
+    assert(added.m_index == find(name));
+    return true;
+}
+
+// See documentation in header
+bool SpeciesRegistry::loadFromFile(
+    const char *path,
+    int &out_errorLine)
+{
+    out_errorLine = 0;
+
+    std::FILE *file = std::fopen(path, "r");
+    if(nullptr == file)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    std::string text;
+    for(int c = std::fgetc(file); EOF != c; c = std::fgetc(file))
+    {
+        text += (char)c;
+    }
+    const bool wasRead = !std::ferror(file);
+    std::fclose(file);
+    if(!wasRead)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    const int initialSize = size();
+    std::istringstream lines(text);
+    std::string line;
+    for(int lineNumber = 1; std::getline(lines, line); ++lineNumber)
+    {
+        if(!addFromLine(line.substr(0, line.find('#'))))
+        {   // !!!! EARLY EXIT !!!!
+            out_errorLine = lineNumber;
+            return false;
+        }
+    }
+
+    return initialSize < size();
+}
+
+// See documentation in header
+void SpeciesRegistry::writeTo(Snapshot::writer &out) const
+{
+    out.write((std::uint32_t)size());
+    for(const species &s : m_species)
+    {
+        out.writeArray(s.m_name.data(), s.m_name.size());
+        out.write((std::int32_t)s.m_attr);
+        out.write((std::int32_t)s.m_capacity);
+        out.write((std::int32_t)s.m_foodValue);
+        out.write((std::uint32_t)s.m_behaviors);
+    }
+}
+
+// See documentation in header
+bool SpeciesRegistry::matchesSaved(Snapshot::reader &in) const
+{
+    std::uint32_t numSpecies = 0;
+    in.read(numSpecies);
+    bool result = in.isValid() && (std::uint32_t)size() == numSpecies;
+
+    std::vector<char> name;
+    for(int i = 0; result && i < size(); ++i)
+    {
+        const species &s(m_species[i]);
+        std::int32_t attr = 0;
+        std::int32_t capacity = 0;
+        std::int32_t foodValue = 0;
+        std::uint32_t behaviors = 0;
+
+        // A saved name longer than the species' name fails in
+        in.readVector(name, s.m_name.size());
+        in.read(attr);
+        in.read(capacity);
+        in.read(foodValue);
+        in.read(behaviors);
+        result = in.isValid() &&
+            std::string(name.begin(), name.end()) == s.m_name &&
+            attr == s.m_attr &&
+            capacity == s.m_capacity &&
+            foodValue == s.m_foodValue &&
+            behaviors == s.m_behaviors;
+    }
+
+    if(!result)
+    {
+        in.fail();
+    }
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Adds the species described by line, a line of a species file
+/// without any comment. Returns true without adding a species if line
+/// is blank. Returns false if line is malformed or describes a
+/// species that cannot be added.
+bool SpeciesRegistry::addFromLine(const std::string &line)
+{
+    std::istringstream tokens(line);
+    std::string name;
+    if(!(tokens >> name))
+    {   // !!!! EARLY EXIT !!!! blank line
+        return true;
+    }
+
+    int attr = (size() % 3) + 1;
+    int capacity = 0;
+    int foodValue = 0;
+    unsigned int behaviors = 0;
+    bool hasCapacity = false;
+    bool hasFoodValue = false;
+    bool hasBehaviors = false;
+    bool result = true;
+    std::string token;
+    while(result && tokens >> token)
+    {
+        if(0 == token.compare(0, 5, "attr="))
+        {
+            result = parseIntField(token, "attr=", attr);
+        }
+        else if(0 == token.compare(0, 9, "capacity="))
+        {
+            result = parseIntField(token, "capacity=", capacity);
+            hasCapacity = true;
+        }
+        else if(0 == token.compare(0, 5, "food="))
+        {
+            result = parseIntField(token, "food=", foodValue);
+            hasFoodValue = true;
+        }
+        else if(0 == token.compare(0, 5, "eats="))
+        {
+            result = parseBehaviors(token.substr(5), behaviors);
+            hasBehaviors = true;
+        }
+        else
+        {
+            result = false;
+        }
+    }
+
+    return result && hasCapacity && hasFoodValue && hasBehaviors &&
+        add(name, attr, capacity, foodValue, behaviors);
+}
@@ -0,0 +1,210 @@
+#ifndef SPECIESREGISTRY_H // Guard
+#define SPECIESREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <cassert>
+#include "Snapshot.h"
+
+class Worm;
+class WormsSim;
+
+
+//////////////////////////////////////////////////////////////////////
+/// SpeciesRegistry stores everything that is different from one
+/// species of worm to another: a name, a display attribute, how much
+/// food each segment stores, how much food each segment provides when
+/// eaten, and how worms of the species eat. A simulation's worms may
+/// be of any species in the registry the simulation was created with.
+///
+/// Registries are built by adding species one at a time or by loading
+/// a text file with one species per line:
+///
+///     # name      attr=A capacity=C food=F eats=BEHAVIOR[,BEHAVIOR...]
+///     Vegetarian   attr=1 capacity=3 food=3 eats=carrots
+///     Scissor-head attr=2 capacity=4 food=5 eats=slice,carrots
+///     Cannibal     attr=3 capacity=5 food=4 eats=cannibalize,carrots
+///
+/// Blank lines and text following '#' are ignored. attr is optional.
+/// The behaviors are "slice" (slice other worms as Scissor-heads do),
+/// "cannibalize" (eat other worms as Cannibals do), "carrots" (eat
+/// carrots as Vegetarians do), or "nothing".
+///
+/// Design Notes:
+/// - The eating of each species is composed from the behaviors when
+/// the species is added. Every combination of behaviors has its own
+/// function, so a worm eats with a single call through a function
+/// pointer no matter how many behaviors its species combines, exactly
+/// as the three original species did.
+/// - Behaviors are always performed in the order slice, cannibalize,
+/// carrots, so that stepping worms concurrently, which eats carrots
+/// in a separate phase, produces the same kind of results as stepping
+/// them one at a time. See WormsSim::setSteppingThreadPool().
+/// - Species are identified by their index in the registry. Worms
+/// store the index in one byte, so a registry has at most
+/// maxNumSpecies species.
+/// - A registry must not change while any simulation created with it
+/// exists. Any number of simulations, including simulations running
+/// on different threads, may share one registry.
+///
+//////////////////////////////////////////////////////////////////////
+class SpeciesRegistry
+{
+public:
+    /// The behaviors from which the eating of a species is composed
+    typedef enum
+    {
+        SLICES = 1,        //< Slices other worms as Scissor-heads do
+        CANNIBALIZES = 2,  //< Eats other worms as Cannibals do
+        GRAZES = 4,        //< Eats carrots as Vegetarians do
+        ALL_BEHAVIORS = 7
+    } behavior;
+
+    /// The maximum number of species in a registry
+    static const int maxNumSpecies = 256;
+
+    /// The display attribute WormsSim gives the remains of dead worms,
+    /// which no species may use. Attribute 0 is used for carrots.
+    static const int remainsAttr = 4;
+
+    /// The largest attribute a species may use
+    static const int maxAttr = 255;
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this class describe one species. Instances are
+    /// created only by SpeciesRegistry.
+    class species
+    {
+    private:
+        friend class SpeciesRegistry;
+        friend class Worm;
+
+        /// Type of function pointer used to implement worm eating
+        typedef void (*EatFunction)(Worm &worm, WormsSim &sim);
+
+        EatFunction m_eatFunction;  //< Implements all of the species' behaviors
+
+        /// Implements the behaviors that slice or eat other worms or
+        /// nullptr if worms of this species eat only carrots. See
+        /// Worm::finishLiving().
+        EatFunction m_huntFunction;
+        int m_attr;             //< See getAttr()
+        int m_capacity;         //< See getCapacity()
+        int m_foodValue;        //< See getFoodValue()
+        unsigned int m_behaviors; //< See getBehaviors()
+        int m_index;            //< See getIndex()
+        std::string m_name;     //< See getName()
+
+    public:
+        const std::string &getName() const { return m_name; }
+
+        /// Arbitrary int from 1 to maxAttr other than remainsAttr
+        /// that user interfaces may use to look up how to draw worms
+        int getAttr() const { return m_attr; }
+
+        /// Amount of food storable per worm segment
+        int getCapacity() const { return m_capacity; }
+
+        /// Nutritional value (food amount) of an eaten segment
+        int getFoodValue() const { return m_foodValue; }
+
+        /// Returns a combination of behavior flags
+        unsigned int getBehaviors() const { return m_behaviors; }
+        bool grazes() const { return 0 != (m_behaviors & GRAZES); }
+        bool hunts() const
+        {
+            return 0 != (m_behaviors & (SLICES | CANNIBALIZES));
+        }
+
+        /// Returns the index of the species in its registry
+        int getIndex() const { return m_index; }
+    };
+
+private:
+    std::string m_name;              //< See getName()
+    std::vector<species> m_species;  //< The species in order of index
+
+    // See documentation in implementation file
+    bool addFromLine(const std::string &line);
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a registry named name with no species.
+    explicit SpeciesRegistry(const std::string &name = "");
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns a registry named "default" containing the three
+    /// original species in the order Vegetarian, Scissor-head,
+    /// Cannibal with their original parameters.
+    static const SpeciesRegistry &getDefault();
+
+    //////////////////////////////////////////////////////////////////
+    /// Stores in out_behaviors the combination of behaviors named in
+    /// text, a comma separated list of the names described above.
+    /// Returns false if any name is unknown.
+    static bool parseBehaviors(
+        const std::string &text,
+        unsigned int &out_behaviors);
+
+    /// @name Non-mutating Accessors
+    /// @{
+
+    /// Returns the registry's name e.g. the file it was loaded from
+    const std::string &getName() const { return m_name; }
+    int size() const { return (int)m_species.size(); }
+
+    /// Returns the species at index i
+    const species &operator[](
+        int i) const { //< 0..size()-1
+        assert(0 <= i && i < size());
+        return m_species[i]; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the index of the species named name or -1 if there is
+    /// no such species.
+    int find(const std::string &name) const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the name, attr, capacity, food value, and behaviors of
+    /// every species in order to out so that matchesSaved() can tell
+    /// whether a snapshot was saved with the same species. The
+    /// registry's own name is not written.
+    void writeTo(Snapshot::writer &out) const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Reads species written by writeTo() from in. Returns true iff
+    /// they are the same species in the same order as this registry's.
+    /// Otherwise returns false and fails in.
+    bool matchesSaved(Snapshot::reader &in) const;
+    /// @}
+
+    /// @name Functions that mutate the registry
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Adds a species with the next index. Returns false and leaves
+    /// the registry unchanged if the registry is full, another species
+    /// has the same name, or a parameter is out of range.
+    bool add(
+        const std::string &name,   //< Not empty and without white space
+        int attr,                  //< 1..maxAttr other than remainsAttr
+        int capacity,              //< 1..1000
+        int foodValue,             //< 0..1000
+        unsigned int behaviors);   //< A combination of behavior flags
+
+    //////////////////////////////////////////////////////////////////
+    /// Adds the species described in the file at path in the format
+    /// described above. Species without an attr are given attributes
+    /// 1, 2, 3, 1, ... by index. Returns false if the file cannot be
+    /// read or any line is malformed or describes a species that
+    /// cannot be added, and sets out_errorLine to the number of the
+    /// first such line or 0 if the file could not be read or
+    /// describes no species. Species on the lines before the error
+    /// are added.
+    bool loadFromFile(
+        const char *path,
+        int &out_errorLine);
+    /// @}
+};
+
+#endif // SPECIESREGISTRY_H
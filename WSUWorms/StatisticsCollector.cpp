@@ -0,0 +1,136 @@
+#include "StatisticsCollector.h"
+#include <cassert>
+
+const int StatisticsCollector::defaultCapacity; //< See documentation in header
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+StatisticsCollector::StatisticsCollector(int numPopulations) :
+    m_isEnabled(false),
+    m_series(NUM_SERIES),
+    m_populations((std::size_t)numPopulations),
+    m_values(),
+    m_populationCounts((std::size_t)numPopulations, 0),
+    m_csvFile(nullptr)
+{
+    assert(0 <= numPopulations);
+    setCapacity(defaultCapacity);
+}
+
+// See documentation in header
+const char *StatisticsCollector::getSeriesName(series s)
+{
+    static const char *names[NUM_SERIES] = {
+        "body_length", "stomach", "carrots", "births", "deaths"};
+
+    assert(0 <= s && s < NUM_SERIES);
+    return names[s];
+}
+
+// See documentation in header
+void StatisticsCollector::setEnabled(bool isEnabled)
+{
+    if(isEnabled && !m_isEnabled)
+    {
+        clear();
+    }
+    m_isEnabled = isEnabled;
+}
+
+// See documentation in header
+void StatisticsCollector::setCapacity(int numSamples)
+{
+    assert(0 < numSamples);
+
+    m_steps = RingBuffer<std::uint64_t>((std::size_t)numSamples);
+    for(RingBuffer<long> &samples : m_series)
+    {
+        samples = RingBuffer<long>((std::size_t)numSamples);
+    }
+    for(RingBuffer<long> &samples : m_populations)
+    {
+        samples = RingBuffer<long>((std::size_t)numSamples);
+    }
+}
+
+// See documentation in header
+void StatisticsCollector::setCsvOutput(std::FILE *file)
+{
+    m_csvFile = file;
+    if(nullptr != m_csvFile)
+    {
+        std::fprintf(m_csvFile, "step");
+        for(int i = 0; i < getNumPopulations(); ++i)
+        {
+            std::fprintf(m_csvFile, ",population_%d", i);
+        }
+        for(int s = 0; s < NUM_SERIES; ++s)
+        {
+            std::fprintf(m_csvFile, ",%s", getSeriesName((series)s));
+        }
+        std::fprintf(m_csvFile, "\n");
+    }
+}
+
+// See documentation in header
+void StatisticsCollector::finishSample(std::uint64_t step)
+{
+    if(m_isEnabled)
+    {
+        m_steps.push_back(step);
+        for(int s = 0; s < NUM_SERIES; ++s)
+        {
+            m_series[s].push_back(m_values[s]);
+        }
+        for(std::size_t i = 0; i < m_populations.size(); ++i)
+        {
+            m_populations[i].push_back(m_populationCounts[i]);
+        }
+    }
+
+    m_values[BIRTHS] = 0;
+    m_values[DEATHS] = 0;
+}
+
+// See documentation in header
+void StatisticsCollector::clear()
+{
+    m_steps.clear();
+    for(RingBuffer<long> &samples : m_series)
+    {
+        samples.clear();
+    }
+    for(RingBuffer<long> &samples : m_populations)
+    {
+        samples.clear();
+    }
+    m_values[BIRTHS] = 0;
+    m_values[DEATHS] = 0;
+}
+
+// See documentation in header
+void StatisticsCollector::onRunFinished()
+{
+    if(nullptr == m_csvFile)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    for(std::size_t j = 0; j < m_steps.size(); ++j)
+    {
+        std::fprintf(m_csvFile, "%llu", (unsigned long long)m_steps[j]);
+        for(const RingBuffer<long> &samples : m_populations)
+        {
+            std::fprintf(m_csvFile, ",%ld", samples[j]);
+        }
+        for(const RingBuffer<long> &samples : m_series)
+        {
+            std::fprintf(m_csvFile, ",%ld", samples[j]);
+        }
+        std::fprintf(m_csvFile, "\n");
+    }
+    std::fflush(m_csvFile);
+}
@@ -0,0 +1,152 @@
+#ifndef STATISTICSCOLLECTOR_H // Guard
+#define STATISTICSCOLLECTOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "RingBuffer.h"
+
+
+//////////////////////////////////////////////////////////////////////
+/// StatisticsCollector keeps a history of the state of a simulation
+/// as time series: one sample per step of the number of living worms
+/// of each type, totals over all living worms, the number of carrots,
+/// and the number of worms born and died during the step. The most
+/// recent samples are kept in ring buffers so that user interfaces can
+/// show trends, and the history can be written as comma separated
+/// values when a simulation run ends.
+///
+/// Design Notes:
+/// - Collectors are disabled by default. A disabled collector takes
+/// no samples, and the only cost of counting births and deaths is an
+/// increment.
+/// - Ring buffers are allocated when the collector is constructed or
+/// its capacity changes, so taking samples never allocates memory.
+/// - Unlike StepProfiler, which accumulates intervals, every sample is
+/// kept until it is replaced by a newer sample, so the history shows
+/// exactly how populations changed from step to step.
+/// - All functions must be called by the thread that runs the
+/// simulation.
+///
+//////////////////////////////////////////////////////////////////////
+class StatisticsCollector
+{
+public:
+    /// The time series sampled in addition to the populations
+    typedef enum
+    {
+        BODY_LENGTH,  //< Total segments of all living worms
+        STOMACH,      //< Total food in the stomachs of all living worms
+        CARROTS,      //< Squares that contain carrots
+        BIRTHS,       //< Worms created during the step
+        DEATHS,       //< Worms that stopped living during the step
+        NUM_SERIES
+    } series;
+
+    /// The number of samples kept unless another capacity is requested
+    static const int defaultCapacity = 1000;
+
+private:
+    bool m_isEnabled;                         //< See setEnabled()
+    RingBuffer<std::uint64_t> m_steps;        //< See getSteps()
+    std::vector<RingBuffer<long>> m_series;   //< See getSeries()
+    std::vector<RingBuffer<long>> m_populations; //< See getPopulationSeries()
+    long m_values[NUM_SERIES];                //< Values of the current sample
+    std::vector<long> m_populationCounts;     //< Populations of the current sample
+    std::FILE *m_csvFile;                     //< See setCsvOutput()
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a disabled collector that keeps defaultCapacity
+    /// samples of numPopulations populations and writes no comma
+    /// separated values.
+    explicit StatisticsCollector(
+        int numPopulations); //< >= 0
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns a short name for s suitable for display or as a column
+    /// name e.g. "body_length".
+    static const char *getSeriesName(series s);
+
+    /// @name Non-mutating Accessors
+    /// @{
+    bool isEnabled() const { return m_isEnabled; }
+    int getCapacity() const { return (int)m_steps.capacity(); }
+    int getNumSamples() const { return (int)m_steps.size(); }
+    int getNumPopulations() const { return (int)m_populations.size(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the step at which each sample was taken, oldest first.
+    /// Every series has the same number of samples.
+    const RingBuffer<std::uint64_t> &getSteps() const { return m_steps; }
+
+    /// Returns the samples of s, oldest first
+    const RingBuffer<long> &getSeries(series s) const { return m_series[s]; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the samples of the population at index i, oldest first.
+    const RingBuffer<long> &getPopulationSeries(
+        int i) const { //< 0..getNumPopulations()-1
+        return m_populations[i]; }
+    /// @}
+
+    /// @name Functions that mutate the collector
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Enables or disables sampling. Enabling a disabled collector
+    /// discards all previous samples.
+    void setEnabled(bool isEnabled);
+
+    //////////////////////////////////////////////////////////////////
+    /// Keeps the numSamples most recent samples. Discards all previous
+    /// samples. This is the only function other than the constructor
+    /// that allocates memory.
+    void setCapacity(
+        int numSamples); //< must be > 0
+
+    //////////////////////////////////////////////////////////////////
+    /// Writes a header row to file. Each subsequent call to
+    /// onRunFinished() writes one row for every sample kept. Pass
+    /// nullptr to stop writing rows. The caller remains responsible
+    /// for closing file.
+    void setCsvOutput(std::FILE *file);
+
+    /// Counts a worm created since the last sample
+    void countBirth() { m_values[BIRTHS] += 1; }
+
+    /// Counts a worm that stopped living since the last sample
+    void countDeath() { m_values[DEATHS] += 1; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the value of s for the current sample. BIRTHS and DEATHS
+    /// are counted by countBirth() and countDeath() instead.
+    void setValue(
+        series s,    //< BODY_LENGTH, STOMACH, or CARROTS
+        long value)
+    {
+        m_values[s] = value;
+    }
+
+    /// Sets the population at index i for the current sample
+    void setPopulationCount(int i, long count) {
+        m_populationCounts[i] = count; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the current sample, taken after step step, to every
+    /// series if the collector is enabled and starts the next sample.
+    void finishSample(std::uint64_t step);
+
+    //////////////////////////////////////////////////////////////////
+    /// Discards all samples and the births and deaths counted so far
+    /// e.g. when a simulation restarts.
+    void clear();
+
+    //////////////////////////////////////////////////////////////////
+    /// Call when a simulation run ends. Writes every sample kept to the
+    /// file passed to setCsvOutput(), if any.
+    void onRunFinished();
+    /// @}
+};
+
+#endif // STATISTICSCOLLECTOR_H
@@ -0,0 +1,131 @@
+#include "StepProfiler.h"
+#include <algorithm>
+#include <cassert>
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+StepProfiler::StepProfiler() :
+    m_isEnabled(false),
+    m_stepsPerInterval(20),
+    m_numSteps(0),
+    m_current(),
+    m_lastInterval(),
+    m_total(),
+    m_csvFile(nullptr)
+{
+}
+
+// See documentation in header
+const char *StepProfiler::getPhaseName(phase p)
+{
+    static const char *names[NUM_PHASES] = {
+        "live", "regrow", "update_board", "redraw", "input"};
+
+    assert(0 <= p && p < NUM_PHASES);
+    return names[p];
+}
+
+// See documentation in header
+void StepProfiler::setEnabled(bool isEnabled)
+{
+    if(isEnabled && !m_isEnabled)
+    {
+        m_numSteps = 0;
+        m_lastInterval = interval();
+        m_total = interval();
+        startInterval();
+    }
+    m_isEnabled = isEnabled;
+}
+
+// See documentation in header
+void StepProfiler::setStepsPerInterval(int numSteps)
+{
+    assert(0 < numSteps);
+    m_stepsPerInterval = numSteps;
+}
+
+// See documentation in header
+void StepProfiler::setCsvOutput(std::FILE *file)
+{
+    m_csvFile = file;
+    if(nullptr != m_csvFile)
+    {
+        std::fprintf(m_csvFile, "step,steps,seconds,steps_per_sec");
+        for(int p = 0; p < NUM_PHASES; ++p)
+        {
+            std::fprintf(m_csvFile, ",%s_ms", getPhaseName((phase)p));
+        }
+        std::fprintf(m_csvFile, ",victim_lookups,carrots_eaten\n");
+    }
+}
+
+// See documentation in header
+void StepProfiler::onStepFinished()
+{
+    if(m_isEnabled)
+    {
+        m_current.numSteps += 1;
+        m_numSteps += 1;
+        if(m_current.numSteps >= m_stepsPerInterval)
+        {
+            finishInterval();
+        }
+    }
+}
+
+// See documentation in header
+void StepProfiler::finishInterval()
+{
+    if(!m_isEnabled || 0 == m_current.numSteps)
+    {   // !!!! EARLY EXIT !!!!
+        return;
+    }
+
+    m_current.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - m_intervalStart).count();
+
+    m_total.numSteps += m_current.numSteps;
+    m_total.seconds += m_current.seconds;
+    for(int p = 0; p < NUM_PHASES; ++p)
+    {
+        m_total.phaseSeconds[p] += m_current.phaseSeconds[p];
+    }
+    m_total.numVictimLookups += m_current.numVictimLookups;
+    m_total.numCarrotsEaten += m_current.numCarrotsEaten;
+
+    if(nullptr != m_csvFile)
+    {
+        const double steps = (double)m_current.numSteps;
+        std::fprintf(m_csvFile, "%ld,%ld,%.6f,%.3f", m_numSteps,
+            m_current.numSteps, m_current.seconds,
+            steps / std::max(m_current.seconds, 1e-9));
+        for(int p = 0; p < NUM_PHASES; ++p)
+        {
+            std::fprintf(m_csvFile, ",%.6f",
+                1000.0 * m_current.phaseSeconds[p] / steps);
+        }
+        std::fprintf(m_csvFile, ",%ld,%ld\n", m_current.numVictimLookups,
+            m_current.numCarrotsEaten);
+    }
+
+    m_lastInterval = m_current;
+    startInterval();
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Discards the measurements of the current interval and starts a new
+/// interval now.
+void StepProfiler::startInterval()
+{
+    m_current = interval();
+    m_intervalStart = std::chrono::steady_clock::now();
+}
@@ -0,0 +1,165 @@
+#ifndef STEPPROFILER_H // Guard
+#define STEPPROFILER_H
+
+#include <chrono>
+#include <cstdio>
+
+
+//////////////////////////////////////////////////////////////////////
+/// StepProfiler measures where the time of each simulation step goes.
+/// Scoped timers add the time spent in each phase of a step, and
+/// counters record how much work was done. Measurements accumulate
+/// in intervals of a fixed number of steps. The most recently
+/// completed interval can be displayed, and every interval can
+/// optionally be written to a file as a row of comma separated
+/// values.
+///
+/// Design Notes:
+/// - Profilers are disabled by default. A disabled profiler never
+/// reads the clock, so the only cost of the timers and counters is a
+/// test of a flag or an increment.
+/// - Timers use std::chrono::steady_clock rather than a processor
+/// cycle counter so that times are in seconds on every platform and
+/// are not affected by changing clock frequencies.
+/// - All functions must be called by the thread that runs the
+/// simulation.
+///
+//////////////////////////////////////////////////////////////////////
+class StepProfiler
+{
+public:
+    /// The timed phases of a simulation step
+    typedef enum
+    {
+        LIVE,           //< Worms live (move, eat, hunt, starve)
+        REGROW,         //< Carrots regrow
+        UPDATE_BOARD,   //< The screen board is updated
+        REDRAW,         //< The user interface draws changed squares
+        INPUT,          //< The user interface handles input and waits
+        NUM_PHASES
+    } phase;
+
+    /// Measurements accumulated over a number of steps
+    struct interval
+    {
+        long numSteps;                    //< Steps finished
+        double seconds;                   //< Wall clock duration
+        double phaseSeconds[NUM_PHASES];  //< Time spent in each phase
+        long numVictimLookups;            //< Searches for worms to slice or eat
+        long numCarrotsEaten;             //< Carrots eaten by worms
+    };
+
+    //////////////////////////////////////////////////////////////////
+    /// Instances add the time from their construction to their
+    /// destruction to one phase of a profiler if the profiler was
+    /// enabled at construction.
+    class scoped_timer
+    {
+    private:
+        StepProfiler &m_profiler;
+        const phase m_phase;
+        const bool m_isTiming;
+        std::chrono::steady_clock::time_point m_start;
+
+    public:
+        scoped_timer(StepProfiler &profiler, phase p) :
+            m_profiler(profiler), m_phase(p),
+            m_isTiming(profiler.m_isEnabled)
+        {
+            if(m_isTiming) { m_start = std::chrono::steady_clock::now(); }
+        }
+
+        ~scoped_timer()
+        {
+            if(m_isTiming)
+            {
+                m_profiler.m_current.phaseSeconds[m_phase] +=
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - m_start).count();
+            }
+        }
+    };
+
+private:
+    bool m_isEnabled;             //< See setEnabled()
+    int m_stepsPerInterval;       //< See setStepsPerInterval()
+    long m_numSteps;              //< Steps finished while enabled
+    interval m_current;           //< Measurements of the current interval
+    interval m_lastInterval;      //< See getLastInterval()
+    interval m_total;             //< See getTotal()
+    std::FILE *m_csvFile;         //< See setCsvOutput()
+
+    /// When the current interval started
+    std::chrono::steady_clock::time_point m_intervalStart;
+
+    // See documentation in implementation file
+    void startInterval();
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a disabled profiler with 20 steps per interval that
+    /// writes no comma separated values.
+    StepProfiler();
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns a short name for p suitable for display or as part of
+    /// a column name e.g. "update_board".
+    static const char *getPhaseName(phase p);
+
+    /// @name Non-mutating Accessors
+    /// @{
+    bool isEnabled() const { return m_isEnabled; }
+    int getStepsPerInterval() const { return m_stepsPerInterval; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the measurements of the most recently completed
+    /// interval. numSteps is 0 if no interval has completed since the
+    /// profiler was last enabled.
+    const interval &getLastInterval() const { return m_lastInterval; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the sum of the measurements of every interval completed
+    /// since the profiler was last enabled.
+    const interval &getTotal() const { return m_total; }
+    /// @}
+
+    /// @name Functions that mutate the profiler
+    /// @{
+
+    //////////////////////////////////////////////////////////////////
+    /// Enables or disables measurement. Enabling a disabled profiler
+    /// discards all previous measurements.
+    void setEnabled(bool isEnabled);
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the number of steps in each interval.
+    void setStepsPerInterval(
+        int numSteps); //< must be > 0
+
+    //////////////////////////////////////////////////////////////////
+    /// Writes a header row to file and then one row for every interval
+    /// completed afterwards. Phase times are in milliseconds per step.
+    /// Pass nullptr to stop writing rows. The caller remains
+    /// responsible for closing file.
+    void setCsvOutput(std::FILE *file);
+
+    /// Counts one search for a worm to slice or eat
+    void countVictimLookup() { m_current.numVictimLookups += 1; }
+
+    /// Counts numCarrots carrots eaten by worms
+    void countCarrotsEaten(long numCarrots) {
+        m_current.numCarrotsEaten += numCarrots; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Call at the end of every simulation step. Completes the current
+    /// interval once it contains getStepsPerInterval() steps.
+    void onStepFinished();
+
+    //////////////////////////////////////////////////////////////////
+    /// Completes the current interval early if it contains any steps
+    /// e.g. when a simulation run ends.
+    void finishInterval();
+    /// @}
+};
+
+#endif // STEPPROFILER_H
@@ -0,0 +1,169 @@
+#include "WorkStealingThreadPool.h"
+#include <algorithm>
+#include <cassert>
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+WorkStealingThreadPool::WorkStealingThreadPool(int numThreads) :
+    m_numQueuedTasks(0),
+    m_numPendingTasks(0),
+    m_nextQueueIndex(0),
+    m_isStopping(false)
+{
+    if(0 >= numThreads)
+    {
+        numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    
+    for(int i = 0; i < numThreads; ++i)
+    {
+        m_queues.push_back(std::unique_ptr<worker_queue>(new worker_queue()));
+    }
+    
+    // Start workers only after every queue exists because workers
+    // steal from each other's queues
+    for(int i = 0; i < numThreads; ++i)
+    {
+        m_threads.push_back(std::thread(
+            &WorkStealingThreadPool::runWorker, this, (std::size_t)i));
+    }
+    
+    assert(numThreads == getNumThreads());
+}
+
+// See documentation in header
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    waitUntilIdle();
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_isStopping = true;
+    }
+    m_wakeCondition.notify_all();
+    
+    for(std::thread &thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+// See documentation in header
+void WorkStealingThreadPool::submit(task t)
+{
+    const std::size_t queueIndex = m_nextQueueIndex++ % m_queues.size();
+    
+    m_numPendingTasks += 1;
+    {
+        worker_queue &queue(*m_queues[queueIndex]);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.pushBack(std::move(t));
+    }
+    {
+        // Changing the count while holding m_wakeMutex guarantees
+        // that a worker about to wait observes the new task
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_numQueuedTasks += 1;
+    }
+    m_wakeCondition.notify_one();
+}
+
+// See documentation in header
+void WorkStealingThreadPool::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_idleCondition.wait(lock, [this] { return 0 == m_numPendingTasks; });
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Adds t after the newest task. If the circular buffer is full, its
+/// capacity doubles and the tasks are moved to the start of the new
+/// buffer in order from oldest to newest.
+void WorkStealingThreadPool::worker_queue::pushBack(task &&t)
+{
+    if(count == tasks.size())
+    {
+        std::vector<task> grown(std::max((std::size_t)8, 2 * tasks.size()));
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            grown[i] = std::move(tasks[(first + i) % tasks.size()]);
+        }
+        tasks.swap(grown);
+        first = 0;
+    }
+    
+    tasks[(first + count) % tasks.size()] = std::move(t);
+    count += 1;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Removes a task from the back of the queue belonging to the worker
+/// at workerIndex or, if that queue is empty, from the front of
+/// another worker's queue. Returns true and stores the task in
+/// out_task if a task was removed. Returns false otherwise.
+bool WorkStealingThreadPool::tryToTakeTask(
+    std::size_t workerIndex, task &out_task)
+{
+    const std::size_t numQueues = m_queues.size();
+    
+    for(std::size_t i = 0; i < numQueues; ++i)
+    {
+        const bool isOwnQueue = (0 == i);
+        worker_queue &queue(*m_queues[(workerIndex + i) % numQueues]);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        
+        if(0 < queue.count)
+        {
+            if(isOwnQueue)
+            {
+                out_task = queue.popBack();
+            }
+            else
+            {   // Steal the oldest task
+                out_task = queue.popFront();
+            }
+            m_numQueuedTasks -= 1;
+            return true; // !!!! EARLY EXIT !!!!
+        }
+    }
+    
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// The function executed by each worker thread: repeatedly takes and
+/// executes tasks, and waits when no tasks are queued, until the pool
+/// is stopping.
+void WorkStealingThreadPool::runWorker(std::size_t workerIndex)
+{
+    for(;;)
+    {
+        task t;
+        if(tryToTakeTask(workerIndex, t))
+        {
+            t();
+            if(0 == --m_numPendingTasks)
+            {
+                std::lock_guard<std::mutex> lock(m_wakeMutex);
+                m_idleCondition.notify_all();
+            }
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait(lock, [this] {
+                return m_isStopping || 0 < m_numQueuedTasks; });
+            if(m_isStopping && 0 == m_numQueuedTasks)
+            {   // !!!! EARLY EXIT !!!!
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+#ifndef WORKSTEALINGTHREADPOOL_H // Guard
+#define WORKSTEALINGTHREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////
+/// WorkStealingThreadPool executes submitted tasks concurrently using
+/// a fixed number of worker threads.
+///
+/// Each worker has its own queue of tasks. Submitted tasks are
+/// distributed among the queues round-robin. A worker takes tasks
+/// from the back of its own queue, and when its own queue is empty it
+/// "steals" tasks from the front of other workers' queues. Workers
+/// therefore rarely contend for the same queue, and no worker sits
+/// idle while any queue contains tasks even when tasks take very
+/// different amounts of time.
+///
+/// Design Notes:
+/// - Tasks must not throw exceptions.
+/// - The pool is intended for coarse grained tasks such as entire
+/// simulation runs or one phase of a step for a large fraction of a
+/// simulation's worms. Each queue is protected by its own mutex,
+/// which is simple and more than fast enough for such tasks.
+///
+//////////////////////////////////////////////////////////////////////
+class WorkStealingThreadPool
+{
+public:
+    /// The type of tasks executed by the pool
+    typedef std::function<void()> task;
+
+private:
+    /// A queue of tasks belonging to one worker. Tasks are stored in
+    /// a circular buffer that grows when full and never shrinks, so
+    /// once a pool has queued its largest batch of tasks, submitting
+    /// and taking tasks does not allocate memory.
+    struct worker_queue
+    {
+        std::mutex mutex;         //< Protects the other members
+        std::vector<task> tasks;  //< Circular buffer of tasks not yet started
+        std::size_t first;        //< Index in tasks of the oldest task
+        std::size_t count;        //< Number of tasks not yet started
+        
+        worker_queue() : first(0), count(0) {}
+        
+        // See documentation in implementation file
+        void pushBack(task &&t);
+        
+        /// Removes and returns the newest task. The queue must not be
+        /// empty.
+        task popBack() {
+            count -= 1;
+            return std::move(tasks[(first + count) % tasks.size()]); }
+        
+        /// Removes and returns the oldest task. The queue must not be
+        /// empty.
+        task popFront() {
+            task result(std::move(tasks[first]));
+            first = (first + 1) % tasks.size();
+            count -= 1;
+            return result; }
+    };
+
+    /// One queue per worker thread
+    std::vector<std::unique_ptr<worker_queue>> m_queues;
+
+    /// The worker threads
+    std::vector<std::thread> m_threads;
+
+    /// Protects m_numQueuedTasks changes that wake workers, and
+    /// m_isStopping
+    std::mutex m_wakeMutex;
+
+    /// Signaled when tasks are submitted or the pool is stopping
+    std::condition_variable m_wakeCondition;
+
+    /// Signaled when the last pending task completes
+    std::condition_variable m_idleCondition;
+
+    /// Number of tasks in queues that no worker has started
+    std::atomic<int> m_numQueuedTasks;
+
+    /// Number of submitted tasks that have not completed
+    std::atomic<int> m_numPendingTasks;
+
+    /// Index of the queue that receives the next submitted task
+    std::atomic<unsigned int> m_nextQueueIndex;
+
+    /// == true iff the destructor has been called
+    bool m_isStopping;
+
+    // See documentation in implementation file
+    bool tryToTakeTask(std::size_t workerIndex, task &out_task);
+
+    // See documentation in implementation file
+    void runWorker(std::size_t workerIndex);
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a pool with numThreads worker threads. If
+    /// numThreads is <= 0, one worker is created for each hardware
+    /// thread of the machine.
+    explicit WorkStealingThreadPool(int numThreads = 0);
+
+    //////////////////////////////////////////////////////////////////
+    /// Waits for all submitted tasks to complete and then stops the
+    /// worker threads.
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+    /// Returns the number of worker threads
+    int getNumThreads() const { return (int)m_threads.size(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Queues t for execution by one of the worker threads. This
+    /// function may be called from any thread including from within
+    /// a task.
+    void submit(task t);
+
+    //////////////////////////////////////////////////////////////////
+    /// Blocks the calling thread until every submitted task has
+    /// completed. Do not call this function from within a task.
+    void waitUntilIdle();
+};
+
+#endif // WORKSTEALINGTHREADPOOL_H
@@ -1,5 +1,6 @@
 #include "Worm.h"
 #include "WormsSim.h"
+#include "DebugInvariants.h"
 #include <algorithm>
 #include <cassert>
 
@@ -8,9 +9,11 @@
 //////////////////////////////////////////////////////////////////////
 
 // See documentation in header
-Worm::Worm(
+Worm Worm::create(
+    WormStore &store,
+    WormStore::size_type index,
     UniqueWormType typeInfo,
-    std::string saying,
+    const std::string &saying,
     int posX,
     int posY,
     WormsSim &sim)
@@ -19,68 +22,134 @@ Worm::Worm(
     assert(posX >= 0 && posX < sim.getWidth());
     assert(posY >= 0 && posY < sim.getHeight());
     
-    m_typeInfo = typeInfo;
-    int count_pre = m_typeInfo->count; // Needed only for post condition
-    m_typeInfo->count += 1;
-    m_direction = NORTH;
+    Worm result(store, index);
+    assert(!result.isAlive());
     
-    // Store the saying reversed so first caharcter in saying will be
-    // the one carried by the worm's head which is the last segment.
-    std::reverse(saying.begin(), saying.end());
+    Population &population(sim.getMutablePopulation());
+    int count_pre = population.getCount(typeInfo); // Needed only for post condition
+    population.increment(typeInfo);
     
     // cause creation of "eraser" segment at index 0 by
     // prepending a ' ' character to saying
-    saying = " " + saying;
+    const std::uint32_t length = (std::uint32_t)saying.size() + 1;
+    store.releaseBlock(index);
+    store.allocateBlock(index, length);
+    store.m_lengths[index] = length;
+    store.m_firstChars[index] = 0;
+    store.m_tailSerials[index] = 0;
+    store.m_typeIndexes[index] = (std::uint8_t)typeInfo->getIndex();
+    store.m_directions[index] = NORTH;
     
-    for(auto c : saying)
-    {
-        m_body.push_back(segment(posX, posY, c));
-    }
+    // Store the saying reversed so first caharcter in saying will be
+    // the one carried by the worm's head which is the last segment.
+    const std::uint32_t offset = store.m_blockOffsets[index];
+    store.m_chars[offset] = ' ';
+    std::reverse_copy(saying.begin(), saying.end(),
+        store.m_chars.begin() + offset + 1);
     
-    m_stomach = (int)m_body.size() * m_typeInfo->capacity;
-    m_status = Worm::ALIVE;
-
-    assert(1 < m_body.size());
-    assert(nullptr != m_typeInfo);
-    assert(Worm::ALIVE == m_status);
-    assert(count_pre == (m_typeInfo->count - 1));
-    assert(m_body[0].c == ' ');
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    // Every segment starts at the same position
+    const WormStore::position start = {
+        (WormStore::coordinate)posX, (WormStore::coordinate)posY};
+    std::fill_n(store.m_positions.begin() + offset, length, start);
+    
+    result.stomach() = result.getLength() * typeInfo->getCapacity();
+    result.setStatus(Worm::ALIVE);
+
+    assert(1 < result.getLength());
+    assert(typeInfo == result.getTypeInfo());
+    assert(Worm::ALIVE == result.getStatus());
+    assert(count_pre == (population.getCount(typeInfo) - 1));
+    assert(result.getBody()[0].c == ' ');
+    assertInvariant(result.areAllSegmentsContiguous(sim));
+    return result;
 }
 
 // See documentation in header
-Worm::Worm(const Worm &original, int truncationIndex) :
-        m_body(original.m_body.begin(),
-        original.m_body.begin()+truncationIndex)
+Worm Worm::createBySlicing(
+    const Worm &original,
+    int truncationIndex,
+    WormStore::size_type index,
+    WormsSim &sim)
 {
-    assert(nullptr != original.m_typeInfo);
-    assert(truncationIndex <= (int)original.m_body.size());
+    assert(nullptr != original.getTypeInfo());
+    assert(truncationIndex <= original.getLength());
     assert(1 < truncationIndex);
     
-    m_typeInfo = original.m_typeInfo;
-    int count_pre = m_typeInfo->count; // Needed only for post condition
-    m_typeInfo->count += 1;
-    m_direction = original.m_direction;
-    m_stomach = original.m_stomach * (int)m_body.size() /
-        (int)original.m_body.size();
-    m_status = original.m_status;
-
-    assert(original.m_stomach >= m_stomach);
-    assert(original.m_status == m_status);
-    assert(truncationIndex == m_body.size());
-    assert(nullptr != m_typeInfo);
-    assert(count_pre == (m_typeInfo->count - 1));
-    assert(m_body[0].c == ' ');
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    WormStore &store(*original.m_store);
+    Worm result(store, index);
+    assert(!result.isAlive());
+    assert(index != original.m_index);
+    
+    Population &population(sim.getMutablePopulation());
+    int count_pre = population.getCount(original.getTypeInfo()); // Needed only for post condition
+    population.increment(original.getTypeInfo());
+    
+    store.releaseBlock(index);
+    store.allocateBlock(index, (std::uint32_t)truncationIndex);
+    store.m_lengths[index] = (std::uint32_t)truncationIndex;
+    store.m_firstChars[index] = 0;
+    store.m_typeIndexes[index] = store.m_typeIndexes[original.m_index];
+    store.m_directions[index] = store.m_directions[original.m_index];
+    result.stomach() = original.stomach() * result.getLength() /
+        original.getLength();
+    result.setStatus(original.getStatus());
+    
+    // Copy the segments from the tail up to but not including
+    // truncationIndex. Segments keep their serial numbers.
+    result.tailSerial() = original.getTailSerial();
+    for(int i = 0; i < truncationIndex; ++i)
+    {
+        const unsigned int serial = result.getTailSerial() + i;
+        const std::uint32_t to = result.positionOffsetOf(serial);
+        const std::uint32_t from = original.positionOffsetOf(serial);
+        store.m_positions[to] = store.m_positions[from];
+        store.m_chars[result.charOffsetOf(i)] =
+            store.m_chars[original.charOffsetOf(i)];
+    }
+
+    // Note: During concurrent steps, original's stomach may be empty
+    // because original moved but has not yet starved.
+    assert(std::max(0, original.stomach()) >= result.stomach());
+    assert(original.getStatus() == result.getStatus());
+    assert(truncationIndex == result.getLength());
+    assert(original.getTypeInfo() == result.getTypeInfo());
+    assert(count_pre == (population.getCount(result.getTypeInfo()) - 1));
+    assert(result.getBody()[0].c == ' ');
+    assertInvariant(result.areAllSegmentsContiguous(sim));
+    return result;
 }
 
 
 // See documentation in header
 void Worm::live(WormsSim &sim)
 {
-    assert(!isAlive() || nullptr != m_typeInfo);
-    assert(!isAlive() || 1 < m_body.size());
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    assert(!isAlive() || nullptr != getTypeInfo());
+    assert(!isAlive() || 1 < getLength());
+    assertInvariant(areAllSegmentsContiguous(sim));
+    
+    if (!isAlive())
+    {   // !!!! EARLY EXIT !!!!
+        assert(0 == getLength() || getBody()[0].c == ' ');
+        assertInvariant(areAllSegmentsContiguous(sim));
+        return;
+    }
+
+    if(move(sim.getRandomModX(numberOfTurnChoices), sim))
+    {
+        getTypeInfo()->m_eatFunction(*this, sim);
+    }
+
+    updateStatusBasedOnStomach(sim);
+    
+    assert(getBody()[0].c == ' ');
+    assertInvariant(areAllSegmentsContiguous(sim));
+}
+
+// See documentation in header
+bool Worm::move(unsigned int turnChoice, const WormsSim &sim)
+{
+    assert(isAlive());
+    assert(turnChoice < numberOfTurnChoices);
     
     /// The number of directions from one board position to any
     /// adjacent board position
@@ -94,135 +163,203 @@ void Worm::live(WormsSim &sim)
     static const int dya[numberDirections] = {
         -1, -1, +0, +1, +1, +1, +0, -1 };
 
-    // The number of possible direction indexes to choose
-    static const int distributionOfSelectableDirections = 16;
-    
     /// Stores DIRECTIONs, a.k.a. indexes into dxa and dya and
     /// indirectly controls frequency and direction of turns made by
     /// the head because because head movement directions are
     /// selected pseudo randomly from this array.
-    static const int nextTurn[distributionOfSelectableDirections] = {
+    static const int nextTurn[numberOfTurnChoices] = {
         0, 0, 0, 0,  0, 0, 0, 0,
         1, 1, 1, 7,  7, 7, 2, 6
     };
 
-    if (!isAlive())
-    {   // !!!! EARLY EXIT !!!!
-        assert(m_body[0].c == ' ');
-        assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
-        return;
-    }
-
-    // Make each body segment move to the position of the next segment
-    auto headIt = getBody().end() - 1;
-    for(auto i = m_body.begin(); i < headIt; ++i)
-    {
-        i->x = (i + 1)->x;
-        i->y = (i + 1)->y;
-    }
-
+    // The worm's state is read once because stores to the one byte
+    // elements of the store could otherwise alias any of it
+    WormStore &store(*m_store);
+    const std::uint32_t blockOffset = store.m_blockOffsets[m_index];
+    const std::uint32_t blockMask = store.m_blockMasks[m_index];
+    const unsigned int tail = store.m_tailSerials[m_index];
+    const int length = (int)store.m_lengths[m_index];
+    const int capacity = getTypeInfo()->getCapacity();
+    
     // Pick a movement direction relative to the current direction
     // from the selectable directions
-    const int dir = (m_direction + nextTurn[WormsSim::getRandomModX(
-        distributionOfSelectableDirections)]) % numberDirections;
+    const int dir = (store.m_directions[m_index] + nextTurn[turnChoice]) %
+        numberDirections;
     
-    m_direction = static_cast<Worm::direction>(dir);
+    store.m_directions[m_index] = (std::uint8_t)dir;
     
     // Move head in chosen direction
-    getHead().y += dya[dir];
-    getHead().x += dxa[dir];
+    const WormStore::position &oldHead(
+        store.m_positions[blockOffset + ((tail + length - 1) & blockMask)]);
+    int headX = oldHead.x + dxa[dir];
+    int headY = oldHead.y + dya[dir];
 
     // Wrap around edges of board
-    if (getHead().y < 0) getHead().y = sim.getHeight() - 1;
-    else if (getHead().y >= sim.getHeight()) getHead().y = 0;
+    if (headY < 0) headY = sim.getHeight() - 1;
+    else if (headY >= sim.getHeight()) headY = 0;
+    
+    if (headX < 0) headX = sim.getWidth() - 1;
+    else if (headX >= sim.getWidth()) headX = 0;
     
-    if (getHead().x < 0) getHead().x = sim.getWidth() - 1;
-    else if (getHead().x >= sim.getWidth()) getHead().x = 0;
+    // Make each body segment move to the position of the next segment
+    // by storing the new head position after the old head and
+    // retiring the old tail position. Each position keeps its serial
+    // number.
+    const WormStore::position newHead = {
+        (WormStore::coordinate)headX, (WormStore::coordinate)headY};
+    store.m_positions[blockOffset + ((tail + length) & blockMask)] = newHead;
+    store.m_tailSerials[m_index] = tail + 1;
     
-    // Limit amount of food in stomach to capacity of body segments
-    m_stomach = std::min((int)getBody().size() * m_typeInfo->capacity,
-        m_stomach);
+    // Limit amount of food in stomach to capacity of body segments and
+    // consume some food
+    int &food(store.m_stomachs[m_index]);
+    food = std::min(length * capacity, food) - 1;
     
-    // Consume some food
-    m_stomach -= 1;
-    if(isHungry())
-    {
-        m_typeInfo->eatFunction(*this, sim);
-    }
+    assert(getBody()[0].c == ' ');
+    assertInvariant(areAllSegmentsContiguous(sim));
+    
+    return isHungry();
+}
 
-    updateStatusBasedOnStomach();
+// See documentation in header
+void Worm::onAteCarrot()
+{
+    assert(isAlive());
     
-    assert(m_body[0].c == ' ');
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    stomach() += foodValueOfCarrot;
 }
 
 // See documentation in header
-void Worm::onWasSlicedAtSegmentIndex( int victimSegmentNumber)
+void Worm::finishLiving(bool wasHungry, WormsSim &sim)
 {
-    assert(1 < m_body.size());
-    assert(victimSegmentNumber < m_body.size());
-    assert(m_body[0].c == ' ');
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    if (!isAlive())
+    {   // !!!! EARLY EXIT !!!! e.g. eaten earlier in the same step
+        return;
+    }
+    
+    if(wasHungry && nullptr != getTypeInfo()->m_huntFunction)
+    {
+        getTypeInfo()->m_huntFunction(*this, sim);
+    }
+    
+    updateStatusBasedOnStomach(sim);
     
-    auto tsegs = m_body.size(); // size before slice
+    assert(getBody()[0].c == ' ');
+    assertInvariant(areAllSegmentsContiguous(sim));
+}
 
-    m_body = std::vector<segment>(
-        m_body.begin() + victimSegmentNumber,
-        m_body.end());
-    m_body[0].c = ' '; // Set new tail sentinel
+// See documentation in header
+void Worm::onWasSlicedAtSegmentIndex(
+    int victimSegmentNumber, WormsSim &sim)
+{
+    assert(1 < getLength());
+    assert(victimSegmentNumber < getLength());
+    assert(getBody()[0].c == ' ');
+    assertInvariant(areAllSegmentsContiguous(sim));
+    
+    int tsegs = getLength(); // size before slice
+
+    // Discard the segments before victimSegmentNumber by advancing
+    // the start of the body
+    m_store->m_firstChars[m_index] += victimSegmentNumber;
+    m_store->m_lengths[m_index] -= victimSegmentNumber;
+    tailSerial() += victimSegmentNumber;
+    m_store->m_chars[charOffsetOf(0)] = ' '; // Set new tail sentinel
     
-    m_stomach = m_stomach * (int)m_body.size() / (int)tsegs;
-    updateStatusBasedOnStomach();
+    stomach() = stomach() * getLength() / tsegs;
+    updateStatusBasedOnStomach(sim);
     
-    assert(m_body.size() == (tsegs - victimSegmentNumber));
-    assert(m_body[0].c == ' ');
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    assert(getLength() == (tsegs - victimSegmentNumber));
+    assert(getBody()[0].c == ' ');
+    assertInvariant(areAllSegmentsContiguous(sim));
 }
 
 // See documentation in header
-void Worm::onWasEaten()
+void Worm::onWasEaten(WormsSim &sim)
 {
-    assert(1 < m_body.size());
-    assert(nullptr != m_typeInfo);
-    assert(m_status == ALIVE); // only alive worms are eaten
-    assert(0 < m_typeInfo->count);
+    assert(1 < getLength());
+    assert(nullptr != getTypeInfo());
+    assert(getStatus() == ALIVE); // only alive worms are eaten
+    
+    Population &population(sim.getMutablePopulation());
+    assert(0 < population.getCount(getTypeInfo()));
 
-    m_status = EATEN;
-    m_typeInfo->count -= 1;
+    setStatus(EATEN);
+    population.decrement(getTypeInfo());
 
-    assert(m_body[0].c == ' ');
-    assert(0 <= m_typeInfo->count);
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    assert(getBody()[0].c == ' ');
+    assert(0 <= population.getCount(getTypeInfo()));
+    assertInvariant(areAllSegmentsContiguous(sim));
 }
 
 // See documentation in header
-int Worm::getNumVegetarians()
+void Worm::onWasKilled(WormsSim &sim)
 {
-    return Worm::vegetarianInfo.count;
+    assert(1 < getLength());
+    assert(nullptr != getTypeInfo());
+    assert(getStatus() == ALIVE); // only alive worms are killed
+    
+    Population &population(sim.getMutablePopulation());
+    assert(0 < population.getCount(getTypeInfo()));
+
+    setStatus(DEAD);
+    population.decrement(getTypeInfo());
+
+    assert(getBody()[0].c == ' ');
+    assert(0 <= population.getCount(getTypeInfo()));
+    assertInvariant(areAllSegmentsContiguous(sim));
 }
 
 // See documentation in header
-int Worm::getNumCanibals()
+void Worm::releaseSegments()
 {
-    return Worm::cannibalInfo.count;
+    assert(!isAlive());
+    
+    m_store->releaseBlock(m_index);
+    
+    assert(0 == getLength());
 }
 
 // See documentation in header
-int Worm::getNumScissorheads()
+int Worm::Population::getNumLiving() const
 {
-    return Worm::scissorInfo.count;
+    int result = 0;
+    for(int count : m_counts) { result += count; }
+    return result;
 }
 
 // See documentation in header
-void Worm::resetWormCounters()
+bool Worm::isRestorable(int width, int height) const
 {
-    Worm::vegetarianInfo.count = 0;
-    Worm::scissorInfo.count = 0;
-    Worm::cannibalInfo.count = 0;
+    if(m_store->m_typeIndexes[m_index] >= m_store->getSpecies().size() ||
+        m_store->m_directions[m_index] > NW ||
+        m_store->m_statuses[m_index] > ALIVE ||
+        (isAlive() && 2 > getLength()))
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+    
+    for(const segment &s : getBody())
+    {
+        if(0 > s.getX() || s.getX() >= width || 0 > s.getY() || s.getY() >= height)
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+    }
     
-    assert(0 == Worm::getNumVegetarians());
-    assert(0 == Worm::getNumCanibals());
-    assert(0 == Worm::getNumScissorheads());
+    return true;
+}
+
+// See documentation in header
+Worm::Population Worm::countPopulation(const WormStore &store)
+{
+    Population result(store.getSpecies().size());
+    for(WormStore::size_type i = 0; i < store.size(); ++i)
+    {
+        const Worm worm(const_cast<WormStore &>(store), i);
+        if(worm.isAlive()) { result.increment(worm.getTypeInfo()); }
+    }
+    return result;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -236,13 +373,13 @@ void Worm::resetWormCounters()
 bool Worm::isHungry() const
 /*   */
 {
-    assert(1 < m_body.size());
-    assert(nullptr != m_typeInfo);
+    assert(1 < getLength());
+    assert(nullptr != getTypeInfo());
     
-    int m = m_stomach;
-    int n = (int)getBody().size() * m_typeInfo->capacity;
+    int m = stomach();
+    int n = getLength() * getTypeInfo()->getCapacity();
 
-    bool result = (m_status == ALIVE && 4 * m < 3 * n);
+    bool result = (getStatus() == ALIVE && 4 * m < 3 * n);
     
     assert((result != 0) ?
         (isAlive() && 4 * m < 3 * n) :
@@ -256,10 +393,10 @@ bool Worm::isHungry() const
 /// of food another worm may obtain by eating this worm.
 /// Returns a value proportional to the body size of the worm.
 int Worm::getFoodValue() const {
-    assert(1 < m_body.size());
-    assert(m_body[0].c == ' ');
+    assert(1 < getLength());
+    assert(getBody()[0].c == ' ');
 
-    return (int)m_body.size() * m_typeInfo->foodValue;
+    return getLength() * getTypeInfo()->getFoodValue();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -268,22 +405,20 @@ int Worm::getFoodValue() const {
 /// function changes the worm status to DEAD, the function also
 /// decrements the count of the number of living instances that have
 /// newly deceased worm's type.
-void Worm::updateStatusBasedOnStomach()
+void Worm::updateStatusBasedOnStomach(WormsSim &sim)
 {
-    assert(0 < m_body.size());
-    assert(nullptr != m_typeInfo);
+    assert(0 < getLength());
+    assert(nullptr != getTypeInfo());
     
-    if (isAlive() && (m_stomach <= 0 || 1 == m_body.size()))
+    if (isAlive() && (stomach() <= 0 || 1 == getLength()))
     {
-        assert(0 < m_typeInfo->count);
-        m_status = DEAD;
-        m_typeInfo->count -= 1;
-        assert(0 <= m_typeInfo->count);
+        setStatus(DEAD);
+        sim.getMutablePopulation().decrement(getTypeInfo());
     }
     
-    assert((1 < m_body.size()) || (m_status == DEAD));
-    assert((0 < m_stomach) || (m_status == DEAD));
-    assert(areAllSegmentsContiguous(WormsSim::getSingletonSim()));
+    assert((1 < getLength()) || (getStatus() == DEAD));
+    assert((0 < stomach()) || (getStatus() == DEAD));
+    assertInvariant(areAllSegmentsContiguous(sim));
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -292,12 +427,13 @@ void Worm::updateStatusBasedOnStomach()
 /// position, {x, y}. Returns 0 otherwise.
 int Worm::segmentIndexAt(int x, int y) const
 {
-    assert(1 < m_body.size());
-    assert(m_body[0].c == ' ');
+    assert(1 < getLength());
+    assert(getBody()[0].c == ' ');
     
-    for(auto i = 1; i < m_body.size(); ++i)
+    for(auto i = 1; i < getLength(); ++i)
     {
-       if(m_body[i].x == x && m_body[i].y == y)
+       const segment s(segmentAt(i));
+       if(s.getX() == x && s.getY() == y)
        {   // NOTE: !!!! EARLY RETURN !!!!
            return (int)i;
        }
@@ -306,75 +442,93 @@ int Worm::segmentIndexAt(int x, int y) const
     return 0;
 }
 
+//////////////////////////////////////////////////////////////////////
+/// This function implements eating logic for worms that eat nothing
+void Worm::NothingEat(Worm &, WormsSim &)
+{
+}
+
 //////////////////////////////////////////////////////////////////////
 /// This function implements eating logic for Vegitarian type worms
-void Worm::Info::VegetarianEat(Worm &worm, WormsSim &sim)
+void Worm::VegetarianEat(Worm &worm, WormsSim &sim)
 {
     if(sim.tryToEatCarrotAt(
-        worm.getHead().x, worm.getHead().y))
+        worm.getHead().getX(), worm.getHead().getY()))
     {
-        worm.m_stomach += foodValueOfCarrot;
+        worm.stomach() += foodValueOfCarrot;
     }
 }
 
 //////////////////////////////////////////////////////////////////////
-/// This function implements eating logic for ScissorHead type worms
-void Worm::Info::ScissorEat(Worm &worm, WormsSim &sim)
+/// This function implements the slicing of other worms by
+/// ScissorHead type worms
+void Worm::ScissorHunt(Worm &worm, WormsSim &sim)
 {
     sim.sliceVictimForWorm(worm);
-    Worm::Info::VegetarianEat(worm, sim);
 }
 
 //////////////////////////////////////////////////////////////////////
-/// This function implements eating logic for Cannibal type worms
-void Worm::Info::CannibalEat(Worm &worm, WormsSim &sim)
+/// This function implements the eating of other worms by Cannibal
+/// type worms
+void Worm::CannibalHunt(Worm &worm, WormsSim &sim)
 {
     int foodValue = sim.eatVictimForWorm(worm);
-    worm.m_stomach += foodValue;
-    Worm::Info::VegetarianEat(worm, sim);
+    worm.stomach() += foodValue;
 }
 
-//////////////////////////////////////////////////////////////////////
-/// Defines the information that distinguishes Vegetarian worms from
-/// other types of worms
-Worm::Info Worm::vegetarianInfo = {
-    Worm::Info::VegetarianEat,
-    1, 3, 3
-};
+/// Type of function pointer used to implement worm eating
+typedef void (*EatFunction)(Worm &worm, WormsSim &sim);
 
 //////////////////////////////////////////////////////////////////////
-/// Defines the information that distinguishes ScissorHead worms from
-/// other types of worms
-Worm::Info Worm::scissorInfo = {
-    Worm::Info::ScissorEat,
-    2, 4, 5
-};
+/// Performs first and then second. Each instantiation is a distinct
+/// function in which both calls may be inlined, so a composed
+/// behavior costs one indirect call just as the hand written
+/// ScissorEat and CannibalEat functions did.
+template <EatFunction first, EatFunction second>
+static void eatInSequence(Worm &worm, WormsSim &sim)
+{
+    first(worm, sim);
+    second(worm, sim);
+}
 
-//////////////////////////////////////////////////////////////////////
-/// Defines the information that distinguishes Cannibal worms from
-/// other types of worms
-Worm::Info Worm::cannibalInfo = {
-    Worm::Info::CannibalEat,
-    3, 5, 4
-};
+// See documentation in header
+void Worm::composeEatFunctions(SpeciesRegistry::species &aSpecies)
+{
+    typedef struct
+    {
+        EatFunction eatFunction;
+        EatFunction huntFunction;
+    } eat_functions;
+
+    /// The eat functions of every combination of behaviors indexed by
+    /// the combination
+    static const eat_functions composed[SpeciesRegistry::ALL_BEHAVIORS + 1] = {
+        {NothingEat, nullptr},
+        {ScissorHunt, ScissorHunt},
+        {CannibalHunt, CannibalHunt},
+        {eatInSequence<ScissorHunt, CannibalHunt>,
+            eatInSequence<ScissorHunt, CannibalHunt>},
+        {VegetarianEat, nullptr},
+        {eatInSequence<ScissorHunt, VegetarianEat>, ScissorHunt},
+        {eatInSequence<CannibalHunt, VegetarianEat>, CannibalHunt},
+        {eatInSequence<eatInSequence<ScissorHunt, CannibalHunt>, VegetarianEat>,
+            eatInSequence<ScissorHunt, CannibalHunt>},
+    };
 
-//////////////////////////////////////////////////////////////////////
-/// An immutable collection of all available worm types
-const std::vector<Worm::UniqueWormType> Worm::UniqueWormTypes = {
-    &Worm::vegetarianInfo,
-    &Worm::scissorInfo,
-    &Worm::cannibalInfo,
-};
+    assert(aSpecies.m_behaviors <= SpeciesRegistry::ALL_BEHAVIORS);
+    aSpecies.m_eatFunction = composed[aSpecies.m_behaviors].eatFunction;
+    aSpecies.m_huntFunction = composed[aSpecies.m_behaviors].huntFunction;
+}
 
 //////////////////////////////////////////////////////////////////////
 /// This function should only be used to test pre and post conditions
 /// of other functions.
 bool Worm::areAllSegmentsContiguous(const WormsSim &sim) const
 {
-    for (auto it = m_body.rbegin()+1; it != m_body.rend(); ++it)
+    for (int i = getLength() - 2; i >= 0; --i)
     {
-        int deltaX = std::abs(it->x - (it-1)->x);
-        int deltaY = std::abs(it->y - (it-1)->y);
+        int deltaX = std::abs(segmentAt(i).getX() - segmentAt(i + 1).getX());
+        int deltaY = std::abs(segmentAt(i).getY() - segmentAt(i + 1).getY());
         
         if((1 < deltaX && deltaX < (sim.getWidth() - 1)) ||
             (1 < deltaY && deltaY < (sim.getHeight() - 1)))
@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 #include <cassert>
+#include "WormStore.h"
+#include "SpeciesRegistry.h"
 
 
 class WormsSim;
@@ -29,6 +31,10 @@ class WormsSim;
 /// worm may eventually be implemented. This class is responsible for
 /// encapsulating worm state irrespective of drawing implemented
 /// elsewhere.
+/// - A Worm instance is a lightweight view of one slot of a
+/// WormStore, which stores the state of every worm in a simulation in
+/// a "structure of arrays" layout. Copying a Worm copies the view, not
+/// the worm.
 /// - Composition ("has-a") relationships are preferred over
 /// inheritance ("is-a") relationships between classes. For example,
 /// each Worm has a reference to a UniqueWormType and an arbitrary
@@ -38,11 +44,11 @@ class WormsSim;
 /// replicating the functionality of pmateti@wright.edu's 2013
 /// worms.cpp, the only aspects of a Worm that vary by “kind” may be
 /// represented using composition (has-a relationships).  Note: A
-/// private “inner” class accessible only within the Worm class
-/// encapsulates all differences between worm types. The kind of a
-/// worm is hidden from and irrelevant to code outside the
-/// implementation of the Worm class. It could be argued that if
-/// inheritance based polymorphism was used to enable worm kind
+/// species in a SpeciesRegistry encapsulates all differences between
+/// worm types, and only the Worm class and the registry can reach how
+/// a species eats. How a worm eats is hidden from and irrelevant to
+/// code outside the implementation of the Worm class. It could be
+/// argued that if inheritance based polymorphism was used to enable worm kind
 /// specialization, hypothetical future Worm subclasses might be
 /// implemented as subclasses of Worm, but that is hardly the only or
 /// best approach: Future "kinds" could be accommodated through
@@ -55,34 +61,12 @@ class WormsSim;
 class Worm
 {
 private:
-    //////////////////////////////////////////////////////////////////
-    /// Instances of this class encapsulate everything that is
-    /// different form one _kind_ of Worm to another.
-    class Info {
-    private:
-        friend class Worm;
-        
-        /// Type of function pointer used to implement worm eating
-        typedef void (*EatFunction)(Worm &worm, WormsSim &sim);
-        
-        const EatFunction eatFunction; //< Implements worm type specific eating logic
-        const int attr;       //< Arbitrary int (may be used key in a map)
-        const int capacity;   //< Amount of food storable per worm segment
-        const int foodValue;  //< nutritional value (food amount) of an eaten segment
-        
-        /// The number of references to this Info (Used for simulation wide statistics)
-        int count;
-
-        // Available predefined EatFunctions
-        static void VegetarianEat(Worm &worm, WormsSim &sim);
-        static void ScissorEat(Worm &worm, WormsSim &sim);
-        static void CannibalEat(Worm &worm, WormsSim &sim);
-
-        Info(EatFunction func, int someAttr, int aCapacity, int aFoodValue) :
-            eatFunction(func), attr(someAttr), capacity(aCapacity),
-            foodValue(aFoodValue), count(0)
-        {}
-    };
+    // Available predefined EatFunctions from which the eating of each
+    // species is composed. See composeEatFunctions().
+    static void NothingEat(Worm &worm, WormsSim &sim);
+    static void VegetarianEat(Worm &worm, WormsSim &sim);
+    static void ScissorHunt(Worm &worm, WormsSim &sim);
+    static void CannibalHunt(Worm &worm, WormsSim &sim);
 
     /// Nutritional value of each carrot eaten by a worm
     static const int foodValueOfCarrot = 2;
@@ -97,19 +81,61 @@ private:
     /// These are the possible statuses for a Worm instance
     typedef enum { EATEN, DEAD, ALIVE } status;
     
-    static Info vegetarianInfo; //< Encapsulates Vegetarian specific data
-    static Info scissorInfo;    //< Encapsulates ScissorHead specific data
-    static Info cannibalInfo;   //< Encapsulates Cannibal specific data
+    /// SpeciesRegistry composes the eat functions of each species
+    /// when the species is added
+    friend class SpeciesRegistry;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Sets the eat and hunt functions of aSpecies to functions that
+    /// perform its behaviors in the order slice, cannibalize, carrots.
+    static void composeEatFunctions(SpeciesRegistry::species &aSpecies);
     
 public:
-    /// Type used to uniquely identify each type of worm
-    /// The fact that this type is a pointer cannot be exploited
-    /// because the Info type is private to this class. This C++ idiom
-    /// is sometimes called a "handle" i.e. an opaque pointer.
-    typedef Info *UniqueWormType;
+    /// Type used to uniquely identify each type of worm: a species in
+    /// the SpeciesRegistry of the worm's simulation. Only Worm and
+    /// SpeciesRegistry may use the eat functions of a species.
+    typedef const SpeciesRegistry::species *UniqueWormType;
     
-    /// This vector contains all possible unique worm types.
-    static const std::vector<UniqueWormType> UniqueWormTypes;
+    /// The number of distinct turnChoice values accepted by move()
+    static const unsigned int numberOfTurnChoices = 16;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this class count the living worms of each type
+    /// within one simulation. Each simulation has its own Population
+    /// so that any number of independent simulations may coexist.
+    /// Only Worm functions change the counts. The counts are stored in
+    /// one dense array indexed by species index, so counting costs the
+    /// same for any number of species.
+    class Population
+    {
+    private:
+        friend class Worm;
+        
+        /// Number of living worms of each type indexed by type index
+        std::vector<int> m_counts;
+        
+        void increment(UniqueWormType type) { m_counts[type->getIndex()] += 1; }
+        void decrement(UniqueWormType type)
+        {
+            assert(0 < m_counts[type->getIndex()]);
+            m_counts[type->getIndex()] -= 1;
+        }
+        
+    public:
+        /// Constructs a Population with no living worms of any of
+        /// numSpecies species
+        explicit Population(int numSpecies) :
+            m_counts((std::size_t)numSpecies, 0) {}
+        
+        /// @name Access Statistics of Worm Types
+        /// @{
+        int getCount(UniqueWormType type) const { return m_counts[type->getIndex()]; }
+        /// Returns number of living instances of the species at index
+        int getCount(int index) const { return m_counts[index]; }
+        int getNumSpecies() const { return (int)m_counts.size(); }
+        int getNumLiving() const;        //< Returns number of living instances of worms of all types
+        /// @}
+    };
     
     //////////////////////////////////////////////////////////////////
     /// Instances of this structure encapsulate information about each
@@ -128,54 +154,188 @@ public:
         int getY() const { return y; }
     };
 
+    //////////////////////////////////////////////////////////////////
+    /// A read only view of the segments of a worm ordered from the
+    /// "eraser" segment at index 0 to the head at index size()-1.
+    /// Because the positions and characters of segments are stored
+    /// separately, segments are accessed by value.
+    class body
+    {
+    public:
+        typedef WormStore::size_type size_type;
+        
+    private:
+        friend class Worm;
+        const WormStore::position *m_positions; //< Positions in the worm's block
+        const char *m_chars;      //< Letter of the segment at index 0
+        unsigned int m_tailSerial; //< Serial number of the segment at index 0
+        std::uint32_t m_mask;     //< Capacity of the worm's block - 1
+        size_type m_size;         //< Number of segments
+        
+        /// The viewed worm's state is copied when the view is created
+        /// so that visiting segments reads only the shared arrays.
+        body(const WormStore &store, size_type wormIndex) :
+            m_positions(store.m_positions.data() + store.m_blockOffsets[wormIndex]),
+            m_chars(store.m_chars.data() + store.m_blockOffsets[wormIndex] +
+                store.m_firstChars[wormIndex]),
+            m_tailSerial(store.m_tailSerials[wormIndex]),
+            m_mask(store.m_blockMasks[wormIndex]),
+            m_size(store.m_lengths[wormIndex]) {}
+        
+    public:
+        /// Iterates over segments from index 0 to the head
+        class const_iterator
+        {
+        private:
+            const body *m_body;   //< The body whose segments are visited
+            size_type m_index;    //< Index of the current segment
+            
+        public:
+            const_iterator(const body *aBody, size_type index) :
+                m_body(aBody), m_index(index) {}
+            segment operator*() const { return (*m_body)[m_index]; }
+            const_iterator &operator++() { ++m_index; return *this; }
+            bool operator==(const const_iterator &other) const {
+                return m_index == other.m_index; }
+            bool operator!=(const const_iterator &other) const {
+                return m_index != other.m_index; }
+        };
+        
+        size_type size() const { return m_size; }
+        segment operator[](size_type i) const {
+            const std::uint32_t offset = (m_tailSerial + (unsigned int)i) & m_mask;
+            return segment(m_positions[offset].x, m_positions[offset].y,
+                m_chars[i]); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_size); }
+    };
+
 private:
-    UniqueWormType        m_typeInfo;   //< once set, type does not change
-    direction             m_direction;  //< its (head's) direction
-    int                   m_stomach;    //< food value
-    status                m_status;     //< EATEN, DEAD, or ALIVE
-    std::vector<segment>  m_body;       //< body parts
- 
-    segment &getHead() { return m_body.back(); }
-    bool isHungry() const;
-    status getStatus() const { return m_status; }
-    void updateStatusBasedOnStomach();
+    WormStore *m_store;           //< The store containing the worm's state
+    WormStore::size_type m_index; //< The worm's slot in m_store
+    
+    /// @name The Worm's State in m_store
+    /// @{
+    UniqueWormType getTypeInfo() const {
+        return &m_store->getSpecies()[m_store->m_typeIndexes[m_index]]; }
+    int &stomach() const { return m_store->m_stomachs[m_index]; }
+    unsigned int &tailSerial() const { return m_store->m_tailSerials[m_index]; }
+    int getLength() const { return (int)m_store->m_lengths[m_index]; }
+    status getStatus() const { return (status)m_store->m_statuses[m_index]; }
+    void setStatus(status aStatus) const {
+        m_store->m_statuses[m_index] = (std::uint8_t)aStatus; }
+    
+    /// Returns the offset in the store's shared arrays of the position
+    /// of the segment with serial number serial
+    std::uint32_t positionOffsetOf(unsigned int serial) const {
+        return m_store->m_blockOffsets[m_index] +
+            (serial & m_store->m_blockMasks[m_index]); }
+    
+    /// Returns the offset in the store's shared arrays of the letter
+    /// carried by the segment at index i
+    std::uint32_t charOffsetOf(body::size_type i) const {
+        return m_store->m_blockOffsets[m_index] +
+            m_store->m_firstChars[m_index] + (std::uint32_t)i; }
+    /// @}
+    
+    segment segmentAt(body::size_type i) const {
+        const std::uint32_t offset = positionOffsetOf(getTailSerial() + (unsigned int)i);
+        return segment(m_store->m_positions[offset].x,
+            m_store->m_positions[offset].y,
+            m_store->m_chars[charOffsetOf(i)]); }
+    void updateStatusBasedOnStomach(WormsSim &sim);
     
     /// This function should only be used for pre and post condition
-    /// assertion checking
+    /// assertion checking. It visits every segment, so use it only
+    /// with assertInvariant(). See DebugInvariants.h.
     bool areAllSegmentsContiguous(const WormsSim &sim) const;
     
 public:
 
     //////////////////////////////////////////////////////////////////
-    /// Constructs a worm instance with enough segments to store one
-    /// each character in saying in a different worm segment. This
-    /// function stores the saying character starting at the worm's
-    /// head (the first character in saying is stored by the head).
+    /// Constructs a view of the worm in the slot at index in store.
+    /// Copying a Worm copies the view, not the worm.
+    Worm(WormStore &store, WormStore::size_type index) :
+        m_store(&store), m_index(index)
+    {
+        assert(index < store.size());
+    }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Stores a new worm with enough segments to store one each
+    /// character in saying in a different worm segment in the slot at
+    /// index in store and returns a view of it. The slot must not
+    /// contain a living worm. This function stores the saying
+    /// character starting at the worm's head (the first character in
+    /// saying is stored by the head).
     /// As a side effect, this function increases the count of the
     /// number of worms with the specified type.
-    Worm(UniqueWormType typeInfo, //< Information about the type of the worm
-        std::string saying, //< The saying that the worm carries one character per segment
+    static Worm create(
+        WormStore &store, //< The store in which the worm is stored
+        WormStore::size_type index, //< The slot in which the worm is stored
+        UniqueWormType typeInfo, //< Information about the type of the worm
+        const std::string &saying, //< The saying that the worm carries one character per segment
         int posX,   //< The initial x position of the worm's segments
         int posY,   //< The initial y position of the worm's segments
         WormsSim &sim); //< The simulation in which the worm will reside
     
     //////////////////////////////////////////////////////////////////
-    /// Constructs a worm instance that contains copies of the range of
-    /// segments from the tail up to but not including the segment at
-    /// truncation index in original.
+    /// Stores a new worm that contains copies of the range of segments
+    /// from the tail up to but not including the segment at truncation
+    /// index in original in the slot at index in original's store and
+    /// returns a view of it. The slot must not contain a living worm.
     /// As a side effect, this function increases the count of the
     /// number of worms with the specified type.
-    Worm(const Worm &original, //< The worm from whom segments are copied into the constructed worm
-        int truncationIndex);  //< Must be greater than 0 and less than the number of segments in original
+    static Worm createBySlicing(
+        const Worm &original,  //< The worm from whom segments are copied into the created worm
+        int truncationIndex,   //< Must be greater than 0 and less than the number of segments in original
+        WormStore::size_type index, //< The slot in which the worm is stored
+        WormsSim &sim);        //< The simulation in which original resides
     
     /// @name Non-mutating Accessors
     /// @{
     int getFoodValue() const;
-    int getAttr() const { return m_typeInfo->attr; }
-    const segment &getHead() const { return m_body.back(); }
-    const std::vector<segment> &getBody() const { return m_body; }
+    int getAttr() const { return getTypeInfo()->getAttr(); }
+    /// Returns the index of the worm's species in its registry
+    int getTypeIndex() const { return m_store->m_typeIndexes[m_index]; }
+    /// Returns true iff the worm's species eats carrots
+    bool grazes() const { return getTypeInfo()->grazes(); }
+    /// Returns true iff the worm's species slices or eats other worms
+    bool hunts() const { return getTypeInfo()->hunts(); }
+    /// Returns the amount of food in the worm's stomach
+    int getStomach() const { return stomach(); }
+    segment getHead() const { return segmentAt(getLength() - 1); }
+    body getBody() const { return body(*m_store, m_index); }
     int segmentIndexAt(int x, int y) const;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the serial number of the segment at index 0. The
+    /// segment at index i has serial number getTailSerial() + i.
+    /// Unlike segment indexes, which change every time a worm moves,
+    /// the serial number of the segment at any board position does
+    /// not change until a different segment occupies the position.
+    /// Serial numbers are unsigned and may wrap around, so the
+    /// difference between two serial numbers is always well defined.
+    unsigned int getTailSerial() const { return m_store->m_tailSerials[m_index]; }
+    WormStore::size_type getIndex() const { return m_index; }
     bool isAlive() const { return getStatus() == ALIVE; }
+    bool isHungry() const;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns true iff the worm's stored state is one that worms in a
+    /// simulation with a board of width columns and height rows can
+    /// have: its type, direction, and status exist, a living worm has
+    /// a head and a tail, and every segment is on the board. Use this
+    /// function to check worms restored from a snapshot.
+    bool isRestorable(
+        int width,        //< The number of columns in the board
+        int height) const; //< The number of rows in the board
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of living worms of each species in store's
+    /// registry e.g. to restore a simulation's population along with
+    /// its worms.
+    static Population countPopulation(const WormStore &store);
     /// @}
     
     
@@ -189,21 +349,61 @@ public:
     //////////////////////////////////////////////////////////////////
     /// Template Method: called when a worm has been sliced
     void onWasSlicedAtSegmentIndex(
-        int victimSegmentNumber);   //< Segment index at which worm was sliced (must be > 0 and < the number of segments in the worm)
+        int victimSegmentNumber,    //< Segment index at which worm was sliced (must be > 0 and < the number of segments in the worm)
+        WormsSim &sim);             //< The simulation in which the worm resides
     
     //////////////////////////////////////////////////////////////////
     /// Template Method: called when worm has been eaten
     /// As a side effect, this function decrements the count of the
     /// number of living instances that have newly eaten worm's type.
-    void onWasEaten();
+    void onWasEaten(
+        WormsSim &sim);             //< The simulation in which the worm resides
+    
+    //////////////////////////////////////////////////////////////////
+    /// Template Method: called when a living worm has been killed
+    /// e.g. at the request of a user. The worm's remains stay on the
+    /// board. As a side effect, this function decrements the count of
+    /// the number of living instances that have the killed worm's
+    /// type.
+    void onWasKilled(
+        WormsSim &sim);             //< The simulation in which the worm resides
+    
+    //////////////////////////////////////////////////////////////////
+    /// Frees the memory used to store the segments of a worm that is
+    /// no longer alive. Afterwards, the worm has no segments.
+    void releaseSegments();
     /// @}
     
-    /// @name Access Simulation Wide Worm Statistics of Worm Types
+    /// @name Phases of live() for Concurrent Stepping
+    /// Calling move(), then onAteCarrot() if the worm was hungry and
+    /// a carrot was taken from its head's position, and then
+    /// finishLiving() has the same effect on the living worm as
+    /// live() except that every kind of worm eats any carrot before
+    /// slicing or eating other worms. Only finishLiving() interacts
+    /// with other worms.
     /// @{
-    static int getNumVegetarians();   //< Returns number of living instances of worms with type Vegetarian
-    static int getNumCanibals();      //< Returns number of living instances of worms with type Cannibal
-    static int getNumScissorheads();  //< Returns number of living instances of worms with type ScissorHead
-    static void resetWormCounters();  //< Sets counters of number of living instances of all types to 0
+    
+    //////////////////////////////////////////////////////////////////
+    /// Moves the living worm's head one square in the direction
+    /// selected by turnChoice relative to its current direction and
+    /// consumes food. Returns isHungry() after moving. This function
+    /// modifies only the worm, so different worms may move
+    /// concurrently.
+    bool move(
+        unsigned int turnChoice, //< Must be < numberOfTurnChoices
+        const WormsSim &sim);    //< The simulation in which the worm resides
+    
+    //////////////////////////////////////////////////////////////////
+    /// Adds the food value of one carrot to the worm's stomach.
+    void onAteCarrot();
+    
+    //////////////////////////////////////////////////////////////////
+    /// If the worm is still alive and was hungry after moving, lets
+    /// worms whose type hunts slice or eat other worms. Then updates
+    /// the worm's status based on its stomach.
+    void finishLiving(
+        bool wasHungry,     //< The value returned by move()
+        WormsSim &sim);     //< The simulation in which the worm resides
     /// @}
 };
 
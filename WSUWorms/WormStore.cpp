@@ -0,0 +1,223 @@
+#include "WormStore.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+//////////////////////////////////////////////////////////////////////
+//                          PUBLIC METHODS
+//////////////////////////////////////////////////////////////////////
+
+// See documentation in header
+WormStore::size_type WormStore::addSlot()
+{
+    const size_type index = size();
+
+    m_typeIndexes.push_back(0);
+    m_directions.push_back(0);
+    m_statuses.push_back(0);
+    m_stomachs.push_back(0);
+    m_tailSerials.push_back(0);
+    m_lengths.push_back(0);
+    m_firstChars.push_back(0);
+    m_blockOffsets.push_back(0);
+    m_blockMasks.push_back(0);
+
+    assert(index + 1 == size());
+    return index;
+}
+
+// See documentation in header
+void WormStore::clear()
+{
+    m_typeIndexes.clear();
+    m_directions.clear();
+    m_statuses.clear();
+    m_stomachs.clear();
+    m_tailSerials.clear();
+    m_lengths.clear();
+    m_firstChars.clear();
+    m_blockOffsets.clear();
+    m_blockMasks.clear();
+    m_segmentPool.reset();
+
+    assert(0 == size());
+}
+
+
+// See documentation in header
+void WormStore::writeTo(Snapshot::writer &out) const
+{
+    out.writeVector(m_typeIndexes);
+    out.writeVector(m_directions);
+    out.writeVector(m_statuses);
+    out.writeVector(m_stomachs);
+    out.writeVector(m_tailSerials);
+    out.writeVector(m_lengths);
+
+    std::uint64_t numSegments = 0;
+    for(std::uint32_t length : m_lengths) { numSegments += length; }
+
+    // Positions are stored in a ring within each block starting at the
+    // position of the worm's tail serial number, so each worm's
+    // positions are copied in at most two pieces
+    out.write(numSegments);
+    char *positions = out.extend((std::size_t)numSegments * sizeof(position));
+    for(size_type i = 0; i < size(); ++i)
+    {
+        const std::uint32_t length = m_lengths[i];
+        if(0 == length)
+        {
+            continue;
+        }
+        const std::uint32_t first = m_tailSerials[i] & m_blockMasks[i];
+        const std::uint32_t numBeforeWrap = std::min(length,
+            m_blockMasks[i] + 1 - first);
+        const position *block = m_positions.data() + m_blockOffsets[i];
+        std::memcpy(positions, block + first, numBeforeWrap * sizeof(position));
+        std::memcpy(positions + numBeforeWrap * sizeof(position), block,
+            (length - numBeforeWrap) * sizeof(position));
+        positions += length * sizeof(position);
+    }
+
+    out.write(numSegments);
+    char *chars = out.extend((std::size_t)numSegments);
+    for(size_type i = 0; i < size(); ++i)
+    {
+        if(0 < m_lengths[i])
+        {
+            std::memcpy(chars, m_chars.data() + m_blockOffsets[i] +
+                m_firstChars[i], m_lengths[i]);
+            chars += m_lengths[i];
+        }
+    }
+}
+
+// See documentation in header
+bool WormStore::readFrom(Snapshot::reader &in)
+{
+    static const std::size_t maxNumSlots = ~(std::uint32_t)0;
+    static const std::size_t maxNumSegments = ~(std::uint32_t)0;
+
+    WormStore result;
+    result.m_species = m_species;
+    std::vector<position> positions;
+    std::vector<char> chars;
+    in.readVector(result.m_typeIndexes, maxNumSlots);
+    in.readVector(result.m_directions, maxNumSlots);
+    in.readVector(result.m_statuses, maxNumSlots);
+    in.readVector(result.m_stomachs, maxNumSlots);
+    in.readVector(result.m_tailSerials, maxNumSlots);
+    in.readVector(result.m_lengths, maxNumSlots);
+    in.readVector(positions, maxNumSegments);
+    in.readVector(chars, maxNumSegments);
+
+    const size_type numSlots = result.m_statuses.size();
+    std::uint64_t numSegments = 0;
+    std::uint64_t segmentCapacity = 0;
+    for(std::uint32_t length : result.m_lengths)
+    {
+        numSegments += length;
+        segmentCapacity += (0 == length) ? 0 : SegmentPool::capacityFor(length);
+    }
+    if(!in.isValid() ||
+        numSlots != result.m_typeIndexes.size() ||
+        numSlots != result.m_directions.size() ||
+        numSlots != result.m_stomachs.size() ||
+        numSlots != result.m_tailSerials.size() ||
+        numSlots != result.m_lengths.size() ||
+        numSegments != positions.size() ||
+        numSegments != chars.size() ||
+        segmentCapacity > maxNumSegments)
+    {   // !!!! EARLY EXIT !!!!
+        in.fail();
+        return false;
+    }
+
+    result.m_firstChars.assign(numSlots, 0);
+    result.m_blockOffsets.assign(numSlots, 0);
+    result.m_blockMasks.assign(numSlots, 0);
+    result.m_positions.reserve((std::size_t)segmentCapacity);
+    result.m_chars.reserve((std::size_t)segmentCapacity);
+
+    std::size_t segmentIndex = 0;
+    for(size_type i = 0; i < numSlots; ++i)
+    {
+        const std::uint32_t length = result.m_lengths[i];
+        if(0 < length)
+        {
+            result.m_lengths[i] = 0;
+            result.allocateBlock(i, length);
+            result.m_lengths[i] = length;
+
+            const std::uint32_t first =
+                result.m_tailSerials[i] & result.m_blockMasks[i];
+            const std::uint32_t numBeforeWrap = std::min(length,
+                result.m_blockMasks[i] + 1 - first);
+            position *block = result.m_positions.data() +
+                result.m_blockOffsets[i];
+            std::memcpy(block + first, positions.data() + segmentIndex,
+                numBeforeWrap * sizeof(position));
+            std::memcpy(block, positions.data() + segmentIndex + numBeforeWrap,
+                (length - numBeforeWrap) * sizeof(position));
+            std::memcpy(result.m_chars.data() + result.m_blockOffsets[i],
+                chars.data() + segmentIndex, length);
+            segmentIndex += length;
+        }
+    }
+
+    // Replacing the shared arrays counts as one reallocation
+    const long numStorageReallocations = m_numStorageReallocations + 1;
+    *this = std::move(result);
+    m_numStorageReallocations = numStorageReallocations;
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//                          PRIVATE METHODS
+//////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////
+/// Gives the slot at index a block with the smallest power of 2
+/// capacity that is >= minimumCapacity. The slot must not already
+/// have a block. The shared arrays grow if the block extends past
+/// their ends. The contents of the block are unspecified.
+void WormStore::allocateBlock(size_type index, std::uint32_t minimumCapacity)
+{
+    assert(index < size());
+    assert(0 == m_blockMasks[index] && 0 == m_lengths[index]);
+
+    const std::uint32_t capacity = SegmentPool::capacityFor(minimumCapacity);
+    m_blockOffsets[index] = m_segmentPool.allocate(capacity);
+    m_blockMasks[index] = capacity - 1;
+
+    const std::size_t extent = m_segmentPool.getExtent();
+    if(extent > m_positions.size())
+    {
+        if(extent > m_positions.capacity())
+        {
+            m_numStorageReallocations += 1;
+        }
+        m_positions.resize(extent);
+        m_chars.resize(extent);
+    }
+
+    assert(m_blockOffsets[index] + capacity <= m_positions.size());
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Makes the block of the slot at index available for reuse by other
+/// slots. Afterwards, the slot has no segments and no block.
+void WormStore::releaseBlock(size_type index)
+{
+    assert(index < size());
+
+    if(0 < m_lengths[index])
+    {
+        m_segmentPool.release(m_blockOffsets[index], m_blockMasks[index] + 1);
+    }
+    m_lengths[index] = 0;
+    m_firstChars[index] = 0;
+    m_blockOffsets[index] = 0;
+    m_blockMasks[index] = 0;
+}
@@ -0,0 +1,164 @@
+#ifndef WORMSTORE_H // Guard
+#define WORMSTORE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <cassert>
+#include "SegmentPool.h"
+#include "Snapshot.h"
+
+class SpeciesRegistry;
+
+//////////////////////////////////////////////////////////////////////
+/// WormStore stores the state of every worm in one simulation in a
+/// "structure of arrays" layout. Each worm occupies a numbered slot.
+/// The state of the worm in slot i is stored at index i of several
+/// parallel arrays, one array per kind of state e.g. stomachs or
+/// directions. The segments of all worms are stored in two shared
+/// arrays, one of positions and one of characters. Each worm owns one
+/// contiguous block of elements in each shared array.
+///
+/// Design Notes:
+/// - Worm instances are views of one slot of a store. The store
+/// itself is only storage. It knows nothing about how worms live.
+/// - Compared with storing each worm as an object that owns its own
+/// heap allocated vector of segments, this layout places the segments
+/// of different worms next to each other in memory, uses 16 bit
+/// coordinates and one byte characters (5 bytes per segment instead of
+/// a padded 12 byte record), and lets loops that visit one kind of
+/// state for every worm read memory sequentially. Characters are kept
+/// apart from positions because moving a worm changes positions only.
+/// - Blocks are handed out by a SegmentPool. Blocks released by dead
+/// worms are reused by later worms, so the shared arrays grow only
+/// when more segments are alive than ever before. clear() resets the
+/// pool but keeps the shared arrays, so a restarted simulation does
+/// not allocate segment storage again until it outgrows every earlier
+/// simulation.
+/// - Elements of different slots and different blocks are distinct
+/// memory locations, so different threads may modify different worms
+/// concurrently as long as no thread adds slots or blocks.
+/// - Each worm's species is stored as an index into the registry set
+/// by setSpecies(), so the species of a worm costs one byte per slot.
+///
+//////////////////////////////////////////////////////////////////////
+class WormStore
+{
+public:
+    /// The type of slot indexes
+    typedef std::vector<int>::size_type size_type;
+
+    /// The type of board coordinates stored for each segment
+    typedef std::int16_t coordinate;
+    
+    /// The position of one segment. Both coordinates of a segment are
+    /// always used together, so they are stored together.
+    struct position
+    {
+        coordinate x;
+        coordinate y;
+    };
+
+private:
+    friend class Worm;
+
+    /// @name Per Worm State Indexed by Slot
+    /// @{
+    std::vector<std::uint8_t> m_typeIndexes;   //< Index of the worm's species in getSpecies()
+    std::vector<std::uint8_t> m_directions;    //< The (head's) direction
+    std::vector<std::uint8_t> m_statuses;      //< EATEN, DEAD, or ALIVE
+    std::vector<int> m_stomachs;               //< Food value
+    std::vector<unsigned int> m_tailSerials;   //< Serial number of segment index 0
+    std::vector<std::uint32_t> m_lengths;      //< Number of segments
+    std::vector<std::uint32_t> m_firstChars;   //< Offset within the block of segment index 0's letter
+    std::vector<std::uint32_t> m_blockOffsets; //< Offset of the worm's block in the shared arrays
+    std::vector<std::uint32_t> m_blockMasks;   //< Capacity of the worm's block - 1
+    /// @}
+
+    /// @name Segments of All Worms
+    /// The position of the segment with serial number s of the worm
+    /// in slot i is at offset m_blockOffsets[i] + (s & m_blockMasks[i])
+    /// in m_positions. The letter carried by the segment at index j
+    /// is at offset m_blockOffsets[i] + m_firstChars[i] + j in m_chars.
+    /// @{
+    std::vector<position> m_positions;
+    std::vector<char> m_chars;
+    /// @}
+
+    /// Hands out blocks of the shared arrays
+    SegmentPool m_segmentPool;
+
+    /// See getNumStorageReallocations()
+    long m_numStorageReallocations;
+
+    /// See getSpecies()
+    const SpeciesRegistry *m_species;
+
+    // See documentation in implementation file
+    void allocateBlock(size_type index, std::uint32_t minimumCapacity);
+
+    // See documentation in implementation file
+    void releaseBlock(size_type index);
+
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Constructs a store with no slots.
+    WormStore() : m_numStorageReallocations(0), m_species(nullptr) {}
+
+    /// Returns the number of slots
+    size_type size() const { return m_statuses.size(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Adds a slot with no segments and returns its index.
+    size_type addSlot();
+
+    //////////////////////////////////////////////////////////////////
+    /// Removes every slot and every block. Previously allocated
+    /// memory is retained for reuse.
+    void clear();
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of segments for which the shared arrays
+    /// have room including segments in unused blocks.
+    std::size_t getSegmentCapacity() const { return m_positions.size(); }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the registry of the species of the worms stored. It
+    /// must be set by setSpecies() before any worm is stored.
+    const SpeciesRegistry &getSpecies() const {
+        assert(nullptr != m_species);
+        return *m_species; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Looks up the species of the worms stored in species from now
+    /// on. species must outlive the store. Neither clear() nor
+    /// readFrom() changes the registry.
+    void setSpecies(const SpeciesRegistry &species) { m_species = &species; }
+
+    /// Returns the pool that hands out blocks of the shared arrays
+    const SegmentPool &getSegmentPool() const { return m_segmentPool; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of times the shared arrays have been moved
+    /// to larger heap allocations since the store was created. Once a
+    /// simulation reaches a steady state this number stops changing.
+    long getNumStorageReallocations() const { return m_numStorageReallocations; }
+
+    //////////////////////////////////////////////////////////////////
+    /// Appends the state of every slot to out. The segments of all
+    /// worms are written contiguously in slot order from each worm's
+    /// segment index 0, so unused blocks and unused elements of blocks
+    /// are not written.
+    void writeTo(Snapshot::writer &out) const;
+
+    //////////////////////////////////////////////////////////////////
+    /// Replaces every slot with slots read from in that were written
+    /// by writeTo(). Each worm with segments gets a new block of the
+    /// smallest capacity that holds them. Returns false, fails in,
+    /// and leaves the store unchanged if the slots read are not
+    /// consistent with each other. Whether the values of the slots
+    /// make sense for worms is not checked.
+    bool readFrom(Snapshot::reader &in);
+};
+
+#endif // WORMSTORE_H
@@ -1,92 +1,95 @@
 #include "WormsSim.h"
+#include "WorkStealingThreadPool.h"
 #include <algorithm>
-#include <memory>
-
-//////////////////////////////////////////////////////////////////////
-// One instance of std::default_random_engine for use anywhere
-// a random number in needed.
-// The initial seed for random number generation vary from run to run
-// and is produced by calling rdev() which is the C++11 preferred
-// mechanism vs. traditional approaches to this seeding subproblem
-// that involve the use of the system clock (e.g., via time(0))
-std::random_device  WormsSim::rdev{};
-std::default_random_engine WormsSim::random_engine{rdev()};
-
-//////////////////////////////////////////////////////////////////////
-/// This variable exists to enable pre and post condition assertion
-/// checking in unrelated modules. If not for the need to check
-/// pre and post conditions, this variable would be an implementation
-/// detail of the WormsSim::initSingletonSim() function.
-static std::unique_ptr<WormsSim> instancePtr(nullptr);
+#include <bitset>
+#include <random>
+#include <utility>
 
 //////////////////////////////////////////////////////////////////////
 //                          PUBLIC METHODS
 //////////////////////////////////////////////////////////////////////
 
 // See documentation in header
-WormsSim &WormsSim::initSingletonSim(
-    int width, //< The width of the 2D array of board squares
-    int height //< The height of the 2D array of board squares
-)
+WormsSim::WormsSim(int width, int height, const SpeciesRegistry &species) :
+    m_species(&species),
+    m_numStoredWorms(0),
+    m_population(species.size()),
+    m_high_water_mark(0),
+    m_numSteps(0),
+    m_carrotRegrowthChance(0),
+    m_statistics(species.size()),
+    m_steppingThreadPool(nullptr),
+    m_eventLog(nullptr),
+    m_recording(nullptr)
 {
-    const WormsSim *instancePtr_pre = instancePtr.get(); // used only for post condition checking
+    assert(0 < species.size());
+    m_worms.setSpecies(species);
+    
+    // The initial seed varies from run to run and is produced by
+    // std::random_device which is the C++11 preferred mechanism vs.
+    // traditional approaches to this seeding subproblem that involve
+    // the use of the system clock (e.g., via time(0))
+    std::random_device rdev;
+    seedRandomNumbers(((std::uint64_t)rdev() << 32) | rdev());
+    
+    m_actual_board_width = std::max(1, std::min(width, getMaxBoardWidth()));
+    m_actual_board_height = std::max(1, std::min(height, getMaxBoardHeight()));
     
-    Worm::resetWormCounters();
+    // Only allocate squares for the actual board dimensions
+    m_passive_board = board(m_actual_board_width, m_actual_board_height);
+    m_screen_board = board(m_actual_board_width, m_actual_board_height);
+    m_carrots = CarrotLayer(m_actual_board_width, m_actual_board_height);
+    m_occupancy = OccupancyIndex(m_actual_board_width, m_actual_board_height);
+    m_changedSquares = PositionSet(m_actual_board_width, m_actual_board_height);
+    m_changedSquares.insertEverything(); // nothing has been displayed
+    m_changedPassiveSquares = PositionSet(m_actual_board_width, m_actual_board_height);
     
-    assert(0 == Worm::getNumCanibals() );
-    assert(0 == Worm::getNumVegetarians() );
-    assert(0 == Worm::getNumScissorheads() );
+    assert(m_actual_board_width <= getMaxBoardWidth());
+    assert(m_actual_board_height <= getMaxBoardHeight());
+    assert(m_passive_board.size() == m_screen_board.size());
+}
 
-    if(nullptr == instancePtr ||
-        instancePtr->getWidth() != width ||
-        instancePtr->getHeight() != height)
+// See description in header
+std::uint64_t WormsSim::computeBoardChecksum() const
+{
+    std::uint64_t result = 0xcbf29ce484222325ULL;
+    for(int y = 0; y < getHeight(); ++y)
     {
-        instancePtr = std::unique_ptr<WormsSim>(
-            new WormsSim(width, height));
+        for(int x = 0; x < getWidth(); ++x)
+        {
+            result = (result ^ (unsigned char)getOnecAt(x, y)) *
+                0x100000001b3ULL;
+            result = (result ^ (unsigned char)getAttrAt(x, y)) *
+                0x100000001b3ULL;
+        }
     }
-
-    assert(nullptr != instancePtr);
-    assert(nullptr == instancePtr_pre ||
-        (instancePtr_pre == instancePtr.get() &&
-         instancePtr->getWidth() == width &&
-         instancePtr->getHeight() == height) ||
-         instancePtr_pre != instancePtr.get());
-    
-    return *instancePtr;
+    return result;
 }
 
-// See documentation in header
-WormsSim &WormsSim::getSingletonSim()
+// See description in header
+void WormsSim::seedRandomNumbers(std::uint64_t seed)
 {
-    assert(nullptr != instancePtr);
-    
-    return *instancePtr;
+    m_random.setSeed(seed);
 }
 
-// See documentation in header
-WormsSim::WormsSim(int width, int height) :
-    m_high_water_mark(0)
+// See description in header
+void WormsSim::setSteppingThreadPool(WorkStealingThreadPool *pool)
 {
-    m_actual_board_width = std::max(1, std::min(width, getMaxBoardWidth()));
-    m_actual_board_height = std::max(1, std::min(height, getMaxBoardHeight()));
-    
-    assert(m_actual_board_width <= getMaxBoardWidth());
-    assert(m_actual_board_height <= getMaxBoardHeight());
+    m_steppingThreadPool = pool;
 }
 
 // See description in header
-unsigned int WormsSim::getRandomModX(unsigned int x)
+void WormsSim::setEventLog(EventLog *log)
 {
-    assert(x > 1);
-    
-    // random_distribution's () operator will return any integer in the
-    // inclusive range 0 to the larges possible unsigned integer.
-    static std::uniform_int_distribution<int> random_distribution(
-        0, std::numeric_limits<unsigned int>::max());
+    assert(nullptr == log || log->isOpen());
+    m_eventLog = log;
+}
 
-    // No output assertion is needed because of the definition of the
-    // C++ modulus, '%', operator
-    return random_distribution(random_engine) % x;
+// See description in header
+void WormsSim::setRecording(Recording::writer *recording)
+{
+    assert(nullptr == recording || recording->isOpen());
+    m_recording = recording;
 }
 
 // See description in header
@@ -98,49 +101,135 @@ void WormsSim::runSimulation(
     int numWorms = minimumNumberOfWorms + getRandomModX(
         variationInNumberOfWoms);
     
+    runSimulation(uiStrategy, numWorms);
+}
+
+// See description in header
+void WormsSim::runSimulation(
+    AbstractWormsSimUIStrategy &uiStrategy,
+    int numWorms)
+{
+    assert(0 <= numWorms);
+    
     sprinkleCarrots();
     m_worms.clear();
+    m_wormGenerations.clear();
+    m_freeSlots = decltype(m_freeSlots)();
+    m_population = Worm::Population(m_species->size());
+    m_wormSquares.clear();
+    m_newlyDeadWormIndexes.clear();
+    m_occupancy.clear();
+    m_numSteps = 0;
     
     for (int i = numWorms; i > 0; i--) { createWorm(); }
+    m_statistics.clear();
     
+    continueSimulation(uiStrategy);
+}
+
+// See description in header
+void WormsSim::continueSimulation(
+    AbstractWormsSimUIStrategy &uiStrategy)
+{
     do { } while(!runSimulationStep(uiStrategy));
+    m_statistics.onRunFinished();
+}
+
+// See description in header
+bool WormsSim::saveSnapshot(const char *path) const
+{
+    Snapshot::writer out;
+    writeTo(out);
+    return out.writeToFile(path);
+}
+
+// See description in header
+bool WormsSim::loadSnapshot(const char *path)
+{
+    Snapshot::reader in(path);
+    const bool isLoaded = readFrom(in);
+    if(isLoaded)
+    {
+        m_statistics.clear();
+    }
+    return isLoaded;
 }
 
 // See description in header
 void WormsSim::createWorm()
 {
-    int typeIndex = WormsSim::getRandomModX(
-        (int)Worm::UniqueWormTypes.size());
+    int typeIndex = getRandomModX(m_species->size());
     
-    std::string aSaying(sayings[WormsSim::getRandomModX(
+    const std::string &aSaying(sayings[getRandomModX(
                     (int)sayings.size())]);
-    int yy = WormsSim::getRandomModX(getHeight());
-    int xx = WormsSim::getRandomModX(getWidth());
+    int yy = getRandomModX(getHeight());
+    int xx = getRandomModX(getWidth());
     
-    Worm::UniqueWormType type(Worm::UniqueWormTypes[typeIndex]);
-    Worm newWorm(type, aSaying, xx, yy, *this);
+    Worm::UniqueWormType type(&(*m_species)[typeIndex]);
     auto index = findSlot();
-    if(index < m_worms.size())
-    {
-        m_worms[index] = newWorm;
-    }
-    else
+    prepareSlot(index);
+    const Worm worm(Worm::create(m_worms, index, type, aSaying, xx, yy, *this));
+    addWormToOccupancy(index);
+    recordEvent(EventLog::BORN, index, 0, worm.getHead(), worm.getTypeIndex());
+    m_statistics.countBirth();
+
+    m_high_water_mark = std::max(m_worms.size(), m_high_water_mark);
+}
+
+// See description in header
+bool WormsSim::isLivingWorm(const worm_handle &handle) const
+{
+    return handle.index < m_worms.size() &&
+        handle.generation == m_wormGenerations[handle.index] &&
+        getWorm(handle.index).isAlive();
+}
+
+// See description in header
+WormsSim::worm_handle WormsSim::getNextLivingWorm(
+    const worm_handle &current) const
+{
+    const WormStore::size_type numWorms = m_worms.size();
+    const WormStore::size_type start =
+        (0 == current.generation) ? numWorms - 1 : current.index;
+    
+    for(WormStore::size_type i = 1; i <= numWorms; ++i)
     {
-        m_worms.push_back(newWorm);
+        const WormStore::size_type index = (start + i) % numWorms;
+        if(getWorm(index).isAlive())
+        {   // !!!! EARLY EXIT !!!!
+            worm_handle result = {index, m_wormGenerations[index]};
+            return result;
+        }
     }
+    
+    worm_handle none = {0, 0};
+    return none;
+}
 
-    m_high_water_mark = std::max(m_worms.size(), m_high_water_mark);
+// See description in header
+bool WormsSim::killWorm(const worm_handle &handle)
+{
+    if(!isLivingWorm(handle))
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+    
+    Worm(m_worms, handle.index).onWasKilled(*this);
+    onWormStoppedLiving(handle.index, EventLog::KILLED);
+    
+    assert(!isLivingWorm(handle));
+    return true;
 }
 
 // See description in header
 void WormsSim::sliceVictimForWorm(Worm &worm)
 {
     int victimSegNum(0);
-    Worm &victim (getVictimWorm(worm, victimSegNum));
+    Worm victim (getVictimWorm(worm, victimSegNum));
     
     if (0 < victimSegNum)
     {
-        sliceVictim(victim, victimSegNum);
+        sliceVictim(worm, victim, victimSegNum);
     }
 }
 
@@ -149,14 +238,17 @@ int WormsSim::eatVictimForWorm(Worm &worm)
 {
     int result = 0;
     int victimSegNum(0);
-    Worm &victim(getVictimWorm(worm, victimSegNum));
+    Worm victim(getVictimWorm(worm, victimSegNum));
     
     assert(0 == victimSegNum || victim.isAlive());
     
     if (0 < victimSegNum && victim.isAlive())
     {
         result = victim.getFoodValue();
-        victim.onWasEaten();
+        recordEvent(EventLog::ATE, worm.getIndex(),
+            m_wormGenerations[victim.getIndex()], worm.getHead(), result);
+        victim.onWasEaten(*this);
+        onWormStoppedLiving(victim.getIndex(), EventLog::EATEN);
     }
     
     return result;
@@ -185,30 +277,87 @@ const std::vector<std::string> WormsSim::sayings = {
 "*Linux-Torvalds#",
 };
 
-// See description in header
-std::vector<Worm>::size_type WormsSim::findSlot() const
+//////////////////////////////////////////////////////////////////////
+/// Prepares the slot in m_worms at index, which must be the value
+/// returned by findSlot(), to store a new living worm and gives the
+/// worm that will be stored a new generation.
+void WormsSim::prepareSlot(WormStore::size_type index)
 {
-    std::vector<Worm>::size_type i = 0;
-    for(; i < m_worms.size(); ++i)
+    assert(index == findSlot());
+    
+    m_numStoredWorms += 1;
+    if(index < m_worms.size())
     {
-        if(!m_worms[i].isAlive())
-        {   // !!!! EARLY EXIT !!!!
-            return i;
-        }
+        m_freeSlots.pop();
+        m_wormGenerations[index] = m_numStoredWorms;
+    }
+    else
+    {
+        m_worms.addSlot();
+        m_wormGenerations.push_back(m_numStoredWorms);
+    }
+    
+    assert(m_worms.size() == m_wormGenerations.size());
+    assert(!getWorm(index).isAlive());
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Records every segment of the living worm at index in m_worms in
+/// m_occupancy.
+void WormsSim::addWormToOccupancy(WormStore::size_type index)
+{
+    const Worm worm(getWorm(index));
+    assert(worm.isAlive());
+    
+    OccupancyIndex::occupant o = {(int)index, worm.getTailSerial()};
+    for(const Worm::segment &s : worm.getBody())
+    {
+        m_occupancy.insert(s.getX(), s.getY(), o);
+        o.serial += 1;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Call this function when the worm at index in m_worms stops being
+/// alive. The function removes every segment of the worm from
+/// m_occupancy so that the worm can no longer be found by
+/// getVictimWorm(), makes the worm's slot available for reuse, and it
+/// arranges for the worm's remains to be added to the passive board
+/// during the next screen board update. cause is recorded in the
+/// event log.
+void WormsSim::onWormStoppedLiving(
+    WormStore::size_type index,
+    EventLog::death_cause cause)
+{
+    const Worm worm(getWorm(index));
+    assert(!worm.isAlive());
+    
+    recordEvent(EventLog::DIED, index, 0, worm.getHead(), cause);
+    m_statistics.countDeath();
+    
+    OccupancyIndex::occupant o = {(int)index, worm.getTailSerial()};
+    for(const Worm::segment &s : worm.getBody())
+    {
+        m_occupancy.remove(s.getX(), s.getY(), o);
+        o.serial += 1;
     }
     
-    return i;
+    m_freeSlots.push(index);
+    m_newlyDeadWormIndexes.push_back(index);
 }
 
 //////////////////////////////////////////////////////////////////////
 /// Set the "passive" value of the square at {x,y} in the "board".
 /// Passive squares are squares that store information other than
-/// living worms e.g. "carrots". A distinction is made between
-/// passive squares and others so that worms segments and carrots
-/// may occupy the same positions.
+/// living worms e.g. remains of dead worms. A distinction is made
+/// between passive squares and others so that worms segments and
+/// remains may occupy the same positions. Any carrot at {x,y} is
+/// covered and no carrot regrows there.
 void WormsSim::setPassiveSquareAt(square s, int x, int y)
 {
-    m_passive_board[x][y] = s;
+    m_passive_board.at(x, y) = s;
+    m_carrots.makeBarren(x, y);
+    m_changedPassiveSquares.insert(x, y);
 }
 
 // See description in header
@@ -217,57 +366,127 @@ bool WormsSim::tryToEatCarrotAt(int x, int y)
     assert(x >= 0 && x < getWidth());
     assert(y >= 0 && y < getHeight());
     
-    auto square = getPassiveSquareAt(x, y);
-    if(carrot == square.onec)
+    if(m_carrots.tryToEat(x, y))
     {
-        square.onec = ' ';
-        setPassiveSquareAt(square, x, y);
+        m_profiler.countCarrotsEaten(1);
+        m_changedPassiveSquares.insert(x, y);
         return true;
     }
     
-    assert(getPassiveSquareAt(x, y).onec != carrot);
-    
     return false;
 }
 
+// See description in header
+void WormsSim::setCarrotRegrowthRate(double rate)
+{
+    assert(0.0 <= rate && rate <= 1.0);
+    
+    const double chance = rate * CarrotLayer::certainRegrowthChance + 0.5;
+    m_carrotRegrowthChance = (0.0 >= rate) ? 0 :
+        std::max((std::uint32_t)1, std::min(CarrotLayer::certainRegrowthChance,
+            (std::uint32_t)chance));
+}
+
 //////////////////////////////////////////////////////////////////////
-/// Places a carrot in every passive board square
+/// Places a carrot in every square and removes all remains of dead
+/// worms from the passive board
 void WormsSim::sprinkleCarrots()
 {
-    m_passive_board = board(); // initializes to carrots at construction
+    m_passive_board.fill(square(' ', default_square_attr));
+    m_carrots.plantEverywhere();
+    m_screen_board.fill(square()); // squares initialize to carrots at construction
+    m_changedPassiveSquares.clear();
+    m_changedSquares.insertEverything();
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Gives each fertile square without a carrot the chance to regrow a
+/// carrot selected by setCarrotRegrowthRate(). Regrown carrots are
+/// recorded as changed passive squares.
+void WormsSim::regrowCarrots()
+{
+    m_carrots.regrow(m_carrotRegrowthChance, m_random,
+        m_changedPassiveSquares);
 }
 
 //////////////////////////////////////////////////////////////////////
 /// Set the attrs and characters in the simulation based on a_worm's
-/// current position and status
+/// current position and status. Every square set is recorded as
+/// changed.
 void WormsSim::updateBoardWithWorm(const Worm &a_worm)
 {
     if(a_worm.isAlive())
     {
+        const int attr = a_worm.getAttr();
         for(const Worm::segment &s : a_worm.getBody())
         {
-            m_screen_board[s.getX()][s.getY()] = square(
-                s.getC(), a_worm.getAttr());
+            m_screen_board.at(s.getX(), s.getY()) = square(s.getC(), attr);
+            PositionSet::position p = {s.getX(), s.getY()};
+            m_wormSquares.push_back(p);
+            m_changedSquares.insert(s.getX(), s.getY());
         }
     }
     else
     {
         for(const Worm::segment &s : a_worm.getBody())
         {
-            m_passive_board[s.getX()][s.getY()] = square(
-                s.getC(), dead_attribute);
+            setPassiveSquareAt(
+                square(s.getC(), dead_attribute), s.getX(), s.getY());
         }
     }
 }
 
 //////////////////////////////////////////////////////////////////////
 /// Set the attrs and characters in the simulation based on the
-/// positions of worms and carrots in the simulation
+/// positions of worms and carrots in the simulation. Rather than
+/// rebuilding the screen board from scratch, only squares that may
+/// have changed since the previous update are rewritten: squares
+/// previously covered by living worms, changed passive squares, and
+/// squares now covered by living worms.
 void WormsSim::updateBoardWithWormsAndCarrots()
 {
-    m_screen_board = m_passive_board; // copy the carrots and possibly dead worms
+    // Worms that stopped being alive leave remains on the passive
+    // board. Remains are added in m_worms order so that the remains
+    // of worms with higher indexes cover others. A worm's slot may
+    // have been reused by a living worm, in which case there are no
+    // remains to add. Once added, the remains no longer need to be
+    // stored by the worm.
+    std::sort(m_newlyDeadWormIndexes.begin(), m_newlyDeadWormIndexes.end());
+    m_newlyDeadWormIndexes.erase(std::unique(m_newlyDeadWormIndexes.begin(),
+        m_newlyDeadWormIndexes.end()), m_newlyDeadWormIndexes.end());
+    for(WormStore::size_type index : m_newlyDeadWormIndexes)
+    {
+        Worm worm(m_worms, index);
+        if(!worm.isAlive())
+        {
+            updateBoardWithWorm(worm);
+            worm.releaseSegments();
+        }
+    }
+    m_newlyDeadWormIndexes.clear();
     
-    for(auto w : m_worms) { updateBoardWithWorm(w); }
+    // Squares covered by living worms during the previous update may
+    // reveal the passive board now
+    for(const PositionSet::position &p : m_wormSquares)
+    {
+        m_screen_board.at(p.x, p.y) = getPassiveSquareAt(p.x, p.y);
+        m_changedSquares.insert(p.x, p.y);
+    }
+    m_wormSquares.clear();
+    
+    // Reveal passive squares changed since the previous update
+    for(const PositionSet::position &p : m_changedPassiveSquares.getPositions())
+    {
+        m_screen_board.at(p.x, p.y) = getPassiveSquareAt(p.x, p.y);
+        m_changedSquares.insert(p.x, p.y);
+    }
+    m_changedPassiveSquares.clear();
+    
+    for(WormStore::size_type i = 0; i < m_worms.size(); ++i)
+    {
+        const Worm w(getWorm(i));
+        if(w.isAlive()) { updateBoardWithWorm(w); }
+    }
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -279,37 +498,261 @@ void WormsSim::updateBoardWithWormsAndCarrots()
 ///
 /// Otherwise, this function sets out_SegementNumber to 0 and returns
 /// in_worm.
-Worm &WormsSim::getVictimWorm(
-    Worm &in_worm,           //< The worm whose head position is used
+Worm WormsSim::getVictimWorm(
+    const Worm &in_worm,     //< The worm whose head position is used
     int &out_SegementNumber  //< Set to 0 or the segment number of the
                              // victim's segment at in_worm's head's position
 )
 {
-    Worm &result(in_worm);
-    const Worm &const_inWorm(in_worm);
-    for(Worm &candidate : m_worms)
-    {
-        const Worm &const_candidate(candidate);
-        if( &const_candidate != &const_inWorm &&
-           candidate.isAlive())
+    const Worm::segment head(in_worm.getHead());
+    m_profiler.countVictimLookup();
+    
+    // Of all the segments at head's position, find the one belonging
+    // to the worm with the lowest index in m_worms and, within that
+    // worm, the segment with the lowest index.
+    WormStore::size_type victimIndex = m_worms.size();
+    out_SegementNumber = 0;
+    m_occupancy.forEachOccupantAt(head.getX(), head.getY(),
+        [&](const OccupancyIndex::occupant &o)
         {
-           out_SegementNumber = candidate.segmentIndexAt(
-               const_inWorm.getHead().getX(),
-               const_inWorm.getHead().getY());
+            const WormStore::size_type candidateIndex = o.wormIndex;
+            const Worm candidate(getWorm(candidateIndex));
+            if(candidateIndex == in_worm.getIndex())
+            {   // !!!! EARLY EXIT !!!! Note: in_worm's own occupants
+                // are not updated until in_worm finishes moving.
+                return;
+            }
+            
+            int segmentNumber = (int)(o.serial - candidate.getTailSerial());
+            
+            assert(candidate.isAlive()); // only living worms are indexed
+            assert(0 <= segmentNumber &&
+                segmentNumber < (int)candidate.getBody().size());
             
-           if(0 != out_SegementNumber)
-           {
-               // !!!! Note: EARLY EXIT !!!!
-               assert((out_SegementNumber == 0) ? (&result == &in_worm) : (&candidate != &in_worm));
-               assert(candidate.isAlive());
-               return candidate;
-           }
+            if(0 != segmentNumber &&
+                (candidateIndex < victimIndex ||
+                 (candidateIndex == victimIndex &&
+                  segmentNumber < out_SegementNumber)))
+            {
+                victimIndex = candidateIndex;
+                out_SegementNumber = segmentNumber;
+            }
+        });
+    
+    if(victimIndex < m_worms.size())
+    {
+        assert(0 != out_SegementNumber);
+        assert(victimIndex != in_worm.getIndex());
+        return Worm(m_worms, victimIndex);
+    }
+    
+    assert(0 == out_SegementNumber);
+    return in_worm;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Appends the state of the simulation to out in the order in which
+/// readFrom() reads it. The occupancy index and the free slots are
+/// not written because they are determined by the worms.
+void WormsSim::writeTo(Snapshot::writer &out) const
+{
+    static const int bitsPerWord = 64;
+    
+    // Reserving roughly the size of the snapshot avoids copying it as
+    // it grows
+    const std::size_t numSquares = m_screen_board.size();
+    out.reserve(out.size() + 4096 + 2 * numSquares * sizeof(square) +
+        numSquares / 4 + 32 * m_worms.size() +
+        (sizeof(WormStore::position) + 1) * m_worms.getSegmentCapacity() +
+        sizeof(PositionSet::position) * m_changedPassiveSquares.getPositions().size());
+    
+    out.write((std::int32_t)m_actual_board_width);
+    out.write((std::int32_t)m_actual_board_height);
+    m_species->writeTo(out);
+    m_random.writeTo(out);
+    out.write(m_carrotRegrowthChance);
+    out.write(m_numStoredWorms);
+    out.write((std::uint64_t)m_high_water_mark);
+    out.write(m_numSteps);
+    
+    m_worms.writeTo(out);
+    out.writeVector(m_wormGenerations);
+    std::vector<std::int32_t> counts;
+    for(int i = 0; i < m_population.getNumSpecies(); ++i)
+    {
+        counts.push_back(m_population.getCount(i));
+    }
+    out.writeVector(counts);
+    
+    m_passive_board.writeTo(out);
+    m_carrots.writeTo(out);
+    m_screen_board.writeTo(out);
+    
+    // Changes not yet applied to the screen board. Only whether a
+    // square is in m_wormSquares matters, so it is written as one bit
+    // per square, which is much smaller than the list when worms
+    // overlap or cover much of the board.
+    std::vector<std::uint64_t> wormSquareBits(
+        (numSquares + bitsPerWord - 1) / bitsPerWord, 0);
+    for(const PositionSet::position &p : m_wormSquares)
+    {
+        const std::size_t i = (std::size_t)p.y * m_actual_board_width + p.x;
+        wormSquareBits[i / bitsPerWord] |= (std::uint64_t)1 << (i % bitsPerWord);
+    }
+    out.writeVector(wormSquareBits);
+    const std::vector<std::uint32_t> newlyDeadWormIndexes(
+        m_newlyDeadWormIndexes.begin(), m_newlyDeadWormIndexes.end());
+    out.writeVector(newlyDeadWormIndexes);
+    out.writeVector(m_changedPassiveSquares.getPositions());
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Replaces the state of the simulation with state read from in that
+/// was written by writeTo() and rebuilds the occupancy index and the
+/// free slots. Returns false and leaves the simulation unchanged if
+/// in fails or the state read is not consistent.
+bool WormsSim::readFrom(Snapshot::reader &in)
+{
+    static const int bitsPerWord = 64;
+    
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+    in.read(width);
+    in.read(height);
+    
+    // Worms store only the index of their species, so a snapshot
+    // saved with different species must not be restored
+    m_species->matchesSaved(in);
+    if(!in.isValid() || 1 > width || width > getMaxBoardWidth() ||
+        1 > height || height > getMaxBoardHeight())
+    {   // !!!! EARLY EXIT !!!!
+        in.fail();
+        return false;
+    }
+    
+    // Everything is read into temporaries so that the simulation does
+    // not change unless the whole snapshot is valid
+    PseudoRandomGenerator random;
+    std::uint32_t carrotRegrowthChance = 0;
+    std::uint64_t numStoredWorms = 0;
+    std::uint64_t highWaterMark = 0;
+    std::uint64_t numSteps = 0;
+    WormStore worms;
+    worms.setSpecies(*m_species);
+    std::vector<std::uint64_t> generations;
+    std::vector<std::int32_t> counts;
+    board passiveBoard;
+    CarrotLayer carrots;
+    board screenBoard;
+    std::vector<std::uint64_t> wormSquareBits;
+    std::vector<std::uint32_t> newlyDeadWormIndexes;
+    std::vector<PositionSet::position> changedPassiveSquares;
+    
+    const std::size_t numSquares = (std::size_t)width * (std::size_t)height;
+    random.readFrom(in);
+    in.read(carrotRegrowthChance);
+    in.read(numStoredWorms);
+    in.read(highWaterMark);
+    in.read(numSteps);
+    worms.readFrom(in);
+    in.readVector(generations, worms.size());
+    in.readVector(counts, (std::size_t)m_species->size());
+    passiveBoard.readFrom(in, width, height);
+    carrots.readFrom(in, width, height);
+    screenBoard.readFrom(in, width, height);
+    in.readVector(wormSquareBits, (numSquares + bitsPerWord - 1) / bitsPerWord);
+    in.readVector(newlyDeadWormIndexes, ~(std::size_t)0);
+    in.readVector(changedPassiveSquares, numSquares);
+    
+    bool isValid = in.isAtEnd() &&
+        carrotRegrowthChance <= CarrotLayer::certainRegrowthChance &&
+        generations.size() == worms.size() &&
+        highWaterMark >= worms.size() &&
+        counts.size() == (std::size_t)m_species->size() &&
+        wormSquareBits.size() == (numSquares + bitsPerWord - 1) / bitsPerWord &&
+        (0 == numSquares % bitsPerWord || 0 == (wormSquareBits.back() >>
+            (numSquares % bitsPerWord)));
+    for(WormStore::size_type i = 0; isValid && i < worms.size(); ++i)
+    {
+        isValid = Worm(worms, i).isRestorable(width, height) &&
+            0 < generations[i] && generations[i] <= numStoredWorms;
+    }
+    
+    // Worms are counted only after every worm's species is known to
+    // exist in m_species
+    const Worm::Population population(isValid ?
+        Worm::countPopulation(worms) : Worm::Population(m_species->size()));
+    for(std::size_t i = 0; isValid && i < counts.size(); ++i)
+    {
+        isValid = counts[i] == population.getCount((int)i);
+    }
+    for(std::uint32_t index : newlyDeadWormIndexes)
+    {
+        isValid = isValid && index < worms.size();
+    }
+    for(const PositionSet::position &p : changedPassiveSquares)
+    {
+        isValid = isValid && 0 <= p.x && p.x < width &&
+            0 <= p.y && p.y < height;
+    }
+    if(!isValid)
+    {   // !!!! EARLY EXIT !!!!
+        in.fail();
+        return false;
+    }
+    
+    m_actual_board_width = width;
+    m_actual_board_height = height;
+    m_random = random;
+    m_carrotRegrowthChance = carrotRegrowthChance;
+    m_numStoredWorms = numStoredWorms;
+    m_high_water_mark = (WormStore::size_type)highWaterMark;
+    m_numSteps = numSteps;
+    m_worms = std::move(worms);
+    m_wormGenerations = std::move(generations);
+    m_population = population;
+    m_passive_board = std::move(passiveBoard);
+    m_carrots = std::move(carrots);
+    m_screen_board = std::move(screenBoard);
+    m_wormSquares.clear();
+    for(std::size_t k = 0; k < wormSquareBits.size(); ++k)
+    {
+        for(std::uint64_t bits = wormSquareBits[k]; 0 != bits; bits &= bits - 1)
+        {
+            const std::uint64_t lowest = bits & (~bits + 1);
+            const std::size_t i = k * bitsPerWord +
+                std::bitset<bitsPerWord>(lowest - 1).count();
+            PositionSet::position p = {(int)(i % width), (int)(i / width)};
+            m_wormSquares.push_back(p);
         }
     }
+    m_newlyDeadWormIndexes.assign(newlyDeadWormIndexes.begin(),
+        newlyDeadWormIndexes.end());
     
-    out_SegementNumber = 0;
-    assert((out_SegementNumber == 0) ? (&result == &in_worm) : (&result != &in_worm));
-    return result;
+    m_changedPassiveSquares = PositionSet(width, height);
+    for(const PositionSet::position &p : changedPassiveSquares)
+    {
+        m_changedPassiveSquares.insert(p.x, p.y);
+    }
+    m_changedSquares = PositionSet(width, height);
+    m_changedSquares.insertEverything();
+    
+    m_freeSlots = decltype(m_freeSlots)();
+    m_occupancy = OccupancyIndex(width, height);
+    m_occupancy.reserve(m_worms.getSegmentCapacity());
+    for(WormStore::size_type i = 0; i < m_worms.size(); ++i)
+    {
+        if(getWorm(i).isAlive())
+        {
+            addWormToOccupancy(i);
+        }
+        else
+        {
+            m_freeSlots.push(i);
+        }
+    }
+    
+    return true;
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -326,6 +769,7 @@ Worm &WormsSim::getVictimWorm(
 /// no existing slot is available seems suspect, but it is consistent
 /// with the behavior of the reference  pmateti@wright.edu sample code.
 void WormsSim::sliceVictim(
+    const Worm &slicer, //< the worm slicing victim
     Worm &victim, //< the worm being sliced
     int victimSegementNumber) //< the segment index where victim is sliced (must be < the number of segments in victim)
 {
@@ -337,25 +781,324 @@ void WormsSim::sliceVictim(
         1 < victimSegementNumber &&
         victimSegementNumber < victim.getBody().size())
     {
-        m_worms[availableIndex] = Worm(victim, victimSegementNumber);
-        victim.onWasSlicedAtSegmentIndex(victimSegementNumber);
+        WormStore::size_type victimIndex = victim.getIndex();
+        recordEvent(EventLog::SLICED, slicer.getIndex(),
+            m_wormGenerations[victimIndex],
+            victim.getBody()[victimSegementNumber], victimSegementNumber);
+        prepareSlot(availableIndex);
+        const Worm newWorm(Worm::createBySlicing(
+            victim, victimSegementNumber, availableIndex, *this));
+        
+        // The new worm's segments keep their serial numbers, so only
+        // the index of the worm that owns them changes.
+        OccupancyIndex::occupant o = {(int)victimIndex, newWorm.getTailSerial()};
+        for(const Worm::segment &s : newWorm.getBody())
+        {
+            OccupancyIndex::occupant newOccupant = {(int)availableIndex, o.serial};
+            m_occupancy.replace(s.getX(), s.getY(), o, newOccupant);
+            o.serial += 1;
+        }
+        recordEvent(EventLog::BORN, availableIndex,
+            m_wormGenerations[victimIndex], newWorm.getHead(),
+            newWorm.getTypeIndex());
+        m_statistics.countBirth();
+        
+        // A worm created during a concurrent step does not move until
+        // the next step
+        if(availableIndex < m_stepRecords.size())
+        {
+            m_stepRecords[availableIndex].hasMoved = false;
+        }
+        
+        victim.onWasSlicedAtSegmentIndex(victimSegementNumber, *this);
+        if(!victim.isAlive())
+        {
+            onWormStoppedLiving(victimIndex, EventLog::STARVED);
+        }
     }
 }
 
-// See description in header
+//////////////////////////////////////////////////////////////////////
+/// Offers every square that may have changed since the changed
+/// squares were last cleared to m_recording and finishes a frame.
+/// User interfaces may clear the changed squares less often than
+/// once per step, so m_recording discards squares that did not
+/// change since its previous frame.
+void WormsSim::recordFrame()
+{
+    assert(nullptr != m_recording);
+    
+    if(m_changedSquares.containsEverything())
+    {
+        for(int y = 0; y < getHeight(); ++y)
+        {
+            for(int x = 0; x < getWidth(); ++x)
+            {
+                const square s(m_screen_board.at(x, y));
+                m_recording->offerSquare(x, y, s.getOnec(), s.getAttr());
+            }
+        }
+    }
+    else
+    {
+        for(const PositionSet::position &p : m_changedSquares.getPositions())
+        {
+            const square s(m_screen_board.at(p.x, p.y));
+            m_recording->offerSquare(p.x, p.y, s.getOnec(), s.getAttr());
+        }
+    }
+    
+    for(int i = 0; i < m_population.getNumSpecies(); ++i)
+    {
+        m_recording->setPopulationCount(i, m_population.getCount(i));
+    }
+    m_recording->finishFrame((std::int64_t)m_numSteps);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Sets the values of the current sample of m_statistics from the
+/// living worms, the population, and the carrots, and finishes the
+/// sample. The time taken is proportional to the number of slots in
+/// m_worms plus the board's area divided by 64.
+void WormsSim::sampleStatistics()
+{
+    long bodyLength = 0;
+    long stomach = 0;
+    for(WormStore::size_type i = 0; i < m_worms.size(); ++i)
+    {
+        const Worm worm(getWorm(i));
+        if(worm.isAlive())
+        {
+            bodyLength += (long)worm.getBody().size();
+            stomach += worm.getStomach();
+        }
+    }
+    m_statistics.setValue(StatisticsCollector::BODY_LENGTH, bodyLength);
+    m_statistics.setValue(StatisticsCollector::STOMACH, stomach);
+    m_statistics.setValue(StatisticsCollector::CARROTS, getNumCarrots());
+    
+    for(int i = 0; i < m_population.getNumSpecies(); ++i)
+    {
+        m_statistics.setPopulationCount(i, m_population.getCount(i));
+    }
+    m_statistics.finishSample(m_numSteps);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Calls live() for every worm and keeps m_occupancy consistent with
+/// the new worm positions. Because the serial numbers of segments do
+/// not change when a worm moves, only the occupant for each moving
+/// worm's old tail is removed and an occupant for its new head is
+/// inserted.
 void WormsSim::makeAllWormsLive()
 {
-   WormsSim &sim = *this;
-   std::for_each(m_worms.begin(), m_worms.end(),
-       [&sim](Worm &worm) mutable { worm.live(sim); });
+    for(WormStore::size_type i = 0; i < m_worms.size(); ++i)
+    {
+        Worm worm(m_worms, i);
+        const Worm &const_worm(worm);
+        if(worm.isAlive())
+        {
+            const Worm::segment oldTail(worm.getBody()[0]);
+            OccupancyIndex::occupant o = {(int)i, worm.getTailSerial()};
+            
+            worm.live(*this);
+            
+            m_occupancy.remove(oldTail.getX(), oldTail.getY(), o);
+            o.serial += (unsigned int)worm.getBody().size();
+            m_occupancy.insert(const_worm.getHead().getX(),
+                const_worm.getHead().getY(), o);
+            assert(o.serial == worm.getTailSerial() + worm.getBody().size() - 1);
+            
+            if(!worm.isAlive())
+            {
+                onWormStoppedLiving(i, EventLog::STARVED);
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Calls task(i) for every i in 0..(numTasks-1) using the threads of
+/// m_steppingThreadPool and returns after every call completes.
+void WormsSim::runTasksConcurrently(
+    int numTasks,
+    const std::function<void(int)> &task)
+{
+    assert(nullptr != m_steppingThreadPool);
+    
+    for(int i = 0; i < numTasks; ++i)
+    {
+        const std::function<void(int)> *taskPtr = &task;
+        m_steppingThreadPool->submit([taskPtr, i] { (*taskPtr)(i); });
+    }
+    m_steppingThreadPool->waitUntilIdle();
 }
 
 //////////////////////////////////////////////////////////////////////
-/// This function executes one simulation step
+/// Has the same purpose as makeAllWormsLive() but updates worms
+/// concurrently in the phases described by setSteppingThreadPool().
+/// Only Worm::move() and the eating of carrots run concurrently.
+/// Each worm is moved by exactly one task, and each carrot is eaten
+/// within exactly one band, so tasks never modify the same data.
+/// Changes to m_occupancy, m_changedPassiveSquares, and the
+/// population happen on the calling thread.
+void WormsSim::makeAllWormsLiveConcurrently()
+{
+    assert(nullptr != m_steppingThreadPool);
+    
+    const WormStore::size_type numWorms = m_worms.size();
+    const int numTasks = 4 * m_steppingThreadPool->getNumThreads();
+    
+    // Draw pseudo random numbers in index order so that results do
+    // not depend on the number of threads
+    m_stepRecords.resize(numWorms);
+    for(WormStore::size_type i = 0; i < numWorms; ++i)
+    {
+        const Worm worm(getWorm(i));
+        step_record &record(m_stepRecords[i]);
+        record.hasMoved = worm.isAlive();
+        record.eatsCarrot = false;
+        record.hunts = false;
+        if(record.hasMoved)
+        {
+            const Worm::segment oldTail(worm.getBody()[0]);
+            record.oldTail.x = oldTail.getX();
+            record.oldTail.y = oldTail.getY();
+            record.oldTailSerial = worm.getTailSerial();
+            record.turnChoice = getRandomModX(Worm::numberOfTurnChoices);
+        }
+    }
+    
+    // Phase 1: Move every living worm. The task captures at most two
+    // words so that std::function stores it without allocating.
+    const WormStore::size_type wormsPerTask =
+        (numWorms + numTasks - 1) / numTasks;
+    runTasksConcurrently(numTasks, [this, wormsPerTask](int task)
+    {
+        const WormStore::size_type end =
+            std::min(m_stepRecords.size(), (task + 1) * wormsPerTask);
+        for(WormStore::size_type i = task * wormsPerTask; i < end; ++i)
+        {
+            step_record &record(m_stepRecords[i]);
+            if(record.hasMoved)
+            {
+                Worm worm(m_worms, i);
+                const bool isHungry = worm.move(record.turnChoice, *this);
+                record.eatsCarrot = isHungry && worm.grazes();
+                record.hunts = isHungry && worm.hunts();
+            }
+        }
+    });
+    
+    // Update m_occupancy with the new positions and sort hungry worms
+    // into bands by the positions of their heads
+    const int bandHeight = (getHeight() + numTasks - 1) / numTasks;
+    m_hungryWormIndexesByBand.resize(numTasks);
+    m_eatenCarrotsByBand.resize(numTasks);
+    for(WormStore::size_type i = 0; i < numWorms; ++i)
+    {
+        const Worm worm(getWorm(i));
+        const step_record &record(m_stepRecords[i]);
+        if(record.hasMoved)
+        {
+            OccupancyIndex::occupant o = {(int)i, record.oldTailSerial};
+            m_occupancy.remove(record.oldTail.x, record.oldTail.y, o);
+            o.serial += (unsigned int)worm.getBody().size();
+            m_occupancy.insert(worm.getHead().getX(), worm.getHead().getY(), o);
+            
+            if(record.eatsCarrot)
+            {
+                m_hungryWormIndexesByBand[
+                    worm.getHead().getY() / bandHeight].push_back(i);
+            }
+        }
+    }
+    
+    // Phase 2: Hungry worms eat carrots
+    runTasksConcurrently(numTasks, [this](int band)
+    {
+        for(WormStore::size_type i : m_hungryWormIndexesByBand[band])
+        {
+            Worm worm(m_worms, i);
+            const PositionSet::position head = {
+                worm.getHead().getX(), worm.getHead().getY()};
+            if(m_carrots.tryToEat(head.x, head.y))
+            {
+                worm.onAteCarrot();
+                m_eatenCarrotsByBand[band].push_back(head);
+            }
+        }
+        m_hungryWormIndexesByBand[band].clear();
+    });
+    
+    for(std::vector<PositionSet::position> &eatenCarrots : m_eatenCarrotsByBand)
+    {
+        m_profiler.countCarrotsEaten((long)eatenCarrots.size());
+        for(const PositionSet::position &p : eatenCarrots)
+        {
+            m_changedPassiveSquares.insert(p.x, p.y);
+        }
+        eatenCarrots.clear();
+    }
+    
+    // Phase 3: Hunt and starve in index order
+    for(WormStore::size_type i = 0; i < numWorms; ++i)
+    {
+        Worm worm(m_worms, i);
+        if(m_stepRecords[i].hasMoved && worm.isAlive())
+        {
+            worm.finishLiving(m_stepRecords[i].hunts, *this);
+            if(!worm.isAlive())
+            {
+                onWormStoppedLiving(i, EventLog::STARVED);
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////
+/// This function executes one simulation step. Each phase of the step
+/// is timed by m_profiler.
 bool WormsSim::runSimulationStep(AbstractWormsSimUIStrategy &uiStrategy)
 {
-    makeAllWormsLive();
-    updateBoardWithWormsAndCarrots();
-    uiStrategy.redrawDisplay();
-    return uiStrategy.processUserInput();
+    m_numSteps += 1;
+    {
+        StepProfiler::scoped_timer timer(m_profiler, StepProfiler::LIVE);
+        if(nullptr == m_steppingThreadPool)
+        {
+            makeAllWormsLive();
+        }
+        else
+        {
+            makeAllWormsLiveConcurrently();
+        }
+    }
+    {
+        StepProfiler::scoped_timer timer(m_profiler, StepProfiler::REGROW);
+        regrowCarrots();
+    }
+    {
+        StepProfiler::scoped_timer timer(m_profiler, StepProfiler::UPDATE_BOARD);
+        updateBoardWithWormsAndCarrots();
+        if(nullptr != m_recording)
+        {
+            recordFrame();
+        }
+        if(m_statistics.isEnabled())
+        {
+            sampleStatistics();
+        }
+    }
+    {
+        StepProfiler::scoped_timer timer(m_profiler, StepProfiler::REDRAW);
+        uiStrategy.redrawDisplay();
+    }
+    bool shouldEnd = false;
+    {
+        StepProfiler::scoped_timer timer(m_profiler, StepProfiler::INPUT);
+        shouldEnd = uiStrategy.processUserInput();
+    }
+    m_profiler.onStepFinished();
+    
+    return shouldEnd;
 }
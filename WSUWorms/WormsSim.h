@@ -1,13 +1,23 @@
 #ifndef WORMSGAME_H // Guard
 #define WORMSGAME_H
 
-#include <array>
-#include <random>
-#include <random>
 #include <cassert>
+#include <cstdint>
+#include <functional>
+#include <queue>
 #include "Worm.h"
+#include "PseudoRandomGenerator.h"
+#include "Board.h"
+#include "OccupancyIndex.h"
+#include "PositionSet.h"
+#include "CarrotLayer.h"
+#include "StepProfiler.h"
+#include "StatisticsCollector.h"
+#include "EventLog.h"
+#include "Recording.h"
 
 class AbstractWormsSimUIStrategy;
+class WorkStealingThreadPool;
 
 
 //////////////////////////////////////////////////////////////////////
@@ -42,12 +52,39 @@ class AbstractWormsSimUIStrategy;
 //////////////////////////////////////////////////////////////////////
 class WormsSim
 {
+public:
+    //////////////////////////////////////////////////////////////////
+    /// Instances of this structure are stable references to worms.
+    /// A handle continues to identify the same worm after other worms
+    /// are created or die, and it never identifies any other worm,
+    /// even after the worm it identifies dies and its slot in
+    /// getWorms() is reused. Handles remain unique when a simulation
+    /// restarts.
+    struct worm_handle
+    {
+        WormStore::size_type index; //< The worm's index in getWorms()
+        std::uint64_t generation;           //< 0 for handles that identify no worm
+    };
+    
 private:
-    static std::random_device  rdev; //< C++11 default pseudo random number device
-    static std::default_random_engine random_engine; //< C++11 default pseudo random number generator
+    /// Worm instances update the simulation's population as they are
+    /// created and as they die. See getMutablePopulation().
+    friend class Worm;
+    
+    /// The benchmark suite measures private steps of the simulation
+    /// in isolation. See benchmark_suite.cpp.
+    friend class WormsSimBenchmarks;
     
-    static const int max_board_width = 100;  ///< Arbitrary value
-    static const int max_board_height = 100; ///< Arbitrary value
+    /// The source of all pseudo random numbers used by the
+    /// simulation. Each simulation has its own generator so that a
+    /// simulation can be reproduced exactly from its seed.
+    PseudoRandomGenerator m_random;
+    
+    /// Boards are allocated with exactly the actual width and height
+    /// requested, so these limits exist only to keep the number of
+    /// squares representable as a signed int.
+    static const int max_board_width = 32767;  ///< Arbitrary large value
+    static const int max_board_height = 32767; ///< Arbitrary large value
     
     /// Stores an arbitrary number of "sayings" which are used when
     /// creating Worm instances.
@@ -55,55 +92,165 @@ private:
     
     /// Arbitrary "display" attributes for each board square.
     /// Attributes can be any information as long as the information is
-    /// encoded as a single signed integer. e.g. an attribute might be
-    /// a key used to look-up graphical properties in a separately
-    /// maintained dictionary, or an attribute might encode RGB
-    /// components of a color.
+    /// encoded as an integer from 0 to max_square_attr. e.g. an
+    /// attribute might be a key used to look-up graphical properties
+    /// in a separately maintained dictionary.
     /// default_square_attr stores the default value used to initialize
     /// each board square.
     static const int default_square_attr = 0;
 
     /// Arbitrary "display" attributes for dead worm segments.
     /// Attributes can be any information as long as the information is
-    /// encoded as a single signed integer. e.g. an attribute might be
-    /// a key used to look-up graphical properties in a separately
-    /// maintained dictionary, or an attribute might encode RGB
-    /// components of a color.
-    static const int dead_attribute = 4;
+    /// encoded as an integer from 0 to max_square_attr. e.g. an
+    /// attribute might be a key used to look-up graphical properties
+    /// in a separately maintained dictionary.
+    static const int dead_attribute = SpeciesRegistry::remainsAttr;
+    
+    /// The largest attribute that a square can store
+    static const int max_square_attr = 255;
     
     static const char carrot = '.'; ///< a carrot indicator char
     
-    /// A "board" is a 2D array of square instances.
-    struct square
+    /// A "board" is a 2D array of square instances. Each square packs
+    /// its character and attribute into 2 bytes, so scanning or
+    /// copying a board moves a quarter of the memory that a padded
+    /// {char, int} pair would.
+    class square
     {
-        char onec;         //< encodes contents of square
-        int attr;          //< Arbitrary encoded attributes
+    private:
+        std::uint16_t m_bits; //< attribute << 8 | character
         
-        square() : onec(WormsSim::carrot), attr(default_square_attr) {}
-        square(char c, int a) : onec(c), attr(a) {}
+    public:
+        square() : m_bits(pack(WormsSim::carrot, default_square_attr)) {}
+        square(char c, int a) : m_bits(pack(c, a)) {}
+        
+        /// Returns the 16 bit encoding of character c and attribute a
+        static std::uint16_t pack(char c, int a) {
+            assert(0 <= a && a <= max_square_attr);
+            return (std::uint16_t)((unsigned int)a << 8 | (unsigned char)c); }
+        
+        char getOnec() const { return (char)(m_bits & 0xff); } //< encodes contents of square
+        int getAttr() const { return m_bits >> 8; }    //< Arbitrary encoded attributes
+        void setOnec(char c) { m_bits = pack(c, getAttr()); }
     };
     
-    /// The type of a single column in the simulation's board
-    typedef std::array<square, max_board_height> board_column;
+    /// The type of the simulation's board: a contiguous row-major
+    /// matrix of squares sized at run time
+    typedef Board<square> board;
     
-    /// The type of the simulation's board
-    typedef std::array<board_column, max_board_width> board;
+    /// The species of the simulation's worms
+    const SpeciesRegistry *m_species;
     
     /// An arbitrary number of worms in the simulation
-    std::vector<Worm> m_worms;
+    WormStore m_worms;
+    
+    /// The generation of the worm in each slot of m_worms. See
+    /// worm_handle.
+    std::vector<std::uint64_t> m_wormGenerations;
+    
+    /// The number of worms stored in m_worms since the simulation was
+    /// created. Generations are assigned by counting worms.
+    std::uint64_t m_numStoredWorms;
+    
+    /// The indexes of slots in m_worms that do not contain living
+    /// worms. The lowest index is on top so that slots are reused in
+    /// the same order as a scan from index 0 would find them.
+    std::priority_queue<WormStore::size_type,
+        std::vector<WormStore::size_type>,
+        std::greater<WormStore::size_type>> m_freeSlots;
+    
+    /// The number of living worms of each type in the simulation
+    Worm::Population m_population;
     
     /// The maximum number of worms that have ever been in the
-    /// simulation simultaneously (per process invocation)
-    std::vector<Worm>::size_type m_high_water_mark;
+    /// simulation simultaneously (per WormsSim instance)
+    WormStore::size_type m_high_water_mark;
+    
+    /// The number of steps run since the simulation last restarted.
+    /// See getNumSteps().
+    std::uint64_t m_numSteps;
     
-    /// A board used to store non-moving simulation elements i.e.
-    /// carrots.
+    /// A board used to store non-moving simulation elements other than
+    /// carrots i.e. the remains of dead worms. Squares without remains
+    /// contain blanks.
     board m_passive_board;
     
+    /// Records which squares contain carrots. A carrot is displayed in
+    /// preference to any remains in the same square of m_passive_board.
+    CarrotLayer m_carrots;
+    
+    /// The chance that a carrot regrows in each fertile square without
+    /// a carrot during each step as a fraction of
+    /// CarrotLayer::certainRegrowthChance. 0 disables regrowth.
+    std::uint32_t m_carrotRegrowthChance;
+    
     /// A board used to store information to be directly presented
-    /// to users
+    /// to users. The screen board is a composite of the passive board
+    /// and living worms that is updated incrementally: only squares
+    /// whose passive or worm contents have changed are rewritten.
     board m_screen_board;
     
+    /// The squares whose screen contents may have changed since
+    /// changes were last cleared
+    PositionSet m_changedSquares;
+    
+    /// The passive board squares that have changed since the screen
+    /// board was last updated
+    PositionSet m_changedPassiveSquares;
+    
+    /// The squares covered by living worms when the screen board was
+    /// last updated
+    std::vector<PositionSet::position> m_wormSquares;
+    
+    /// Indexes within m_worms of worms that have stopped being alive
+    /// since the screen board was last updated
+    std::vector<WormStore::size_type> m_newlyDeadWormIndexes;
+    
+    /// Records which segments of living worms occupy each board
+    /// position so that getVictimWorm() need not examine every
+    /// segment of every worm.
+    OccupancyIndex m_occupancy;
+    
+    /// Measures the phases of each step. See getProfiler().
+    StepProfiler m_profiler;
+    
+    /// Keeps a history of populations and totals. See getStatistics().
+    StatisticsCollector m_statistics;
+    
+    /// The thread pool used to update worms concurrently or nullptr
+    /// if worms are updated one at a time. See setSteppingThreadPool().
+    WorkStealingThreadPool *m_steppingThreadPool;
+    
+    /// The log that records population events or nullptr if events
+    /// are not recorded. See setEventLog().
+    EventLog *m_eventLog;
+    
+    /// The recording of the screen board after every step or nullptr
+    /// if steps are not recorded. See setRecording().
+    Recording::writer *m_recording;
+    
+    /// Bookkeeping about one worm during a concurrent step
+    struct step_record
+    {
+        PositionSet::position oldTail; //< Position of segment index 0 before moving
+        unsigned int oldTailSerial;    //< Serial number of segment index 0 before moving
+        unsigned int turnChoice;       //< Pseudo random value passed to Worm::move()
+        bool hasMoved;                 //< == true iff the worm was alive and has moved
+        bool eatsCarrot;               //< == true iff hungry after moving and grazes
+        bool hunts;                    //< == true iff hungry after moving and hunts
+    };
+    
+    /// One step_record per element of m_worms during a concurrent step
+    std::vector<step_record> m_stepRecords;
+    
+    /// The indexes of hungry worms whose heads are within each
+    /// horizontal band of the board during a concurrent step
+    std::vector<std::vector<WormStore::size_type>> m_hungryWormIndexesByBand;
+    
+    /// The positions of carrots eaten within each horizontal band of
+    /// the board during a concurrent step
+    std::vector<std::vector<PositionSet::position>> m_eatenCarrotsByBand;
+    
     /// The actual width of the simulation's boards
     int m_actual_board_width;
 
@@ -115,7 +262,38 @@ private:
     /// storing lots and lots of non-living Worms in m_worms. Returns
     /// the first index within m_worms that contains a non living
     /// worm. Returns m_worms.size() if no suitable index is found.
-    std::vector<Worm>::size_type findSlot() const;
+    WormStore::size_type findSlot() const {
+        return m_freeSlots.empty() ? m_worms.size() : m_freeSlots.top(); }
+
+    // See description in implementation file
+    void prepareSlot(WormStore::size_type index);
+
+    // See description in implementation file
+    void addWormToOccupancy(WormStore::size_type index);
+
+    // See description in implementation file
+    void onWormStoppedLiving(
+        WormStore::size_type index,
+        EventLog::death_cause cause);
+    
+    //////////////////////////////////////////////////////////////////
+    /// Records an event about the worm in the slot at index in m_worms
+    /// at the position of segment s if events are being recorded. The
+    /// worm is identified by its generation.
+    void recordEvent(
+        EventLog::event_type type,
+        WormStore::size_type index,
+        std::uint64_t otherWormId,
+        const Worm::segment &s,
+        int value)
+    {
+        if(nullptr != m_eventLog)
+        {
+            EventLog::event e = {m_numSteps, type, m_wormGenerations[index],
+                otherWormId, s.getX(), s.getY(), value};
+            m_eventLog->record(e);
+        }
+    }
 
     /// This function should be called any time a Worm in m_worms changes
     /// state e.g the worm has moved, been eaten, or has died.
@@ -125,10 +303,24 @@ private:
 
     // See description in implementation file
     void updateBoardWithWormsAndCarrots();
+    
+    // See description in implementation file
+    void recordFrame();
+    
+    // See description in implementation file
+    void sampleStatistics();
 
     // See description in implementation file
     void makeAllWormsLive();
 
+    // See description in implementation file
+    void makeAllWormsLiveConcurrently();
+
+    // See description in implementation file
+    void runTasksConcurrently(
+        int numTasks,
+        const std::function<void(int)> &task);
+
     // See description in implementation file
     bool runSimulationStep(AbstractWormsSimUIStrategy &uiStrategy);
 
@@ -138,66 +330,130 @@ private:
     // See description in implementation file
     void setPassiveSquareAt(square s, int x, int y);
 
+    /// Returns the square displayed at {x,y} when no living worm covers
+    /// the square: a carrot if there is one, otherwise m_passive_board.
+    square getPassiveSquareAt(int x, int y) const {
+        return m_carrots.contains(x, y) ? square() : m_passive_board.at(x, y); }
+
     // See description in implementation file
-    square getPassiveSquareAt(int x, int y) const { return m_passive_board[x][y]; }
+    void regrowCarrots();
 
     // See description in implementation file
-    square getScreenSquareAt(int x, int y) const { return m_screen_board[x][y]; }
+    square getScreenSquareAt(int x, int y) const { return m_screen_board.at(x, y); }
 
     // See description in implementation file
-    Worm &getVictimWorm(
-        Worm &in_worm,
+    Worm getVictimWorm(
+        const Worm &in_worm,
         int &out_SegementNumber);
 
     // See description in implementation file
-    void sliceVictim(Worm &victim, int victimSegementNumber);
+    void sliceVictim(
+        const Worm &slicer,
+        Worm &victim,
+        int victimSegementNumber);
     
+    // See description in implementation file
+    void writeTo(Snapshot::writer &out) const;
+    
+    // See description in implementation file
+    bool readFrom(Snapshot::reader &in);
+    
+    /// Returns the population that Worm instances update as they are
+    /// created and as they die
+    Worm::Population &getMutablePopulation() { return m_population; }
+    
+public:
+    //////////////////////////////////////////////////////////////////
     /// Constructs a WormsSim instance encapsulating a board with
     /// width columns and height rows of squares. If the width or
     /// height specified exceeds the values of getMaxBoardWidth() and
     /// getMaxBoardHeight() respectively, the maximum values are used.
-    /// Newly created WormsSim instances have a pseudo random number
-    /// of living Worm instances of pseudo random types and a board
-    /// containing a carrot at every position.
+    /// Any number of WormsSim instances may exist at the same time.
+    /// Each instance has its own board, worms, population counts, and
+    /// pseudo random number generator, so instances are completely
+    /// independent of each other. Newly created WormsSim instances
+    /// have no worms until runSimulation() is called. Worms are
+    /// created with species chosen at random from species, which must
+    /// contain at least one species and must outlive the simulation.
+    /// Simulations may share a registry.
     WormsSim(
         int width, //< The width of the 2D array of board squares
-        int height //< The height of the 2D array of board squares
+        int height, //< The height of the 2D array of board squares
+        const SpeciesRegistry &species = SpeciesRegistry::getDefault()
     );
     
-public:
     //////////////////////////////////////////////////////////////////
-    /// This function creates an instance of WormsSim with the
-    /// specified board width and height.
-    /// If the width or height specified exceeds
-    /// the values of getMaxBoardWidth() and getMaxBoardHeight()
-    /// respectively, the maximum values are used.
-    /// There can only be one instance of WormsSim at a time. If this
-    /// function is called when a WormsSim instance containing a board
-    /// with the specified dimensions already exists, a reference to
-    /// the pre-existing WormsSim instance is returned. Otherwise, a
-    /// new WormsSim instance is created that replaces any
-    /// pre-existing WormsSim instance, and a reference to the new
-    /// WormsSim instance is returned.
-    /// Newly created WormsSim instances have a pseudo random number
-    /// of living Worm instances of pseudo random types.
-    /// As a side effect, this function resents the counters of live
-    /// worm instances of each type prior to creating new worm
-    /// instances that increase the counts.
-    static WormsSim &initSingletonSim(
-        int width, //< The width of the 2D array of board squares
-        int height //< The height of the 2D array of board squares
-    );
-
+    /// Utility function to return a pseudo random natural number in
+    /// the range 0..(x-1) from the simulation's own generator.
+    unsigned int getRandomModX(
+        unsigned int x) //< must be > 0
+    {
+        return m_random.nextModX(x);
+    }
+    
     //////////////////////////////////////////////////////////////////
-    /// This function should only be used for pre and post condition
-    /// assertion checking
-    static WormsSim &getSingletonSim();
+    /// Reseeds the simulation's pseudo random number generator. Newly
+    /// created simulations are seeded nondeterministically. After
+    /// reseeding with the same seed, the same sequence of calls to
+    /// the simulation's functions produces bit-identical boards.
+    void seedRandomNumbers(
+        std::uint64_t seed); //< any value
     
     //////////////////////////////////////////////////////////////////
-    /// Utility function to return a pseudo random natural number in
-    /// the range 0..(x-1).
-    static unsigned int getRandomModX(
-        unsigned int x); //< must be > 1
+    /// Selects how subsequent simulation steps update worms. If pool
+    /// is nullptr, the default, each worm in turn moves and then eats
+    /// before the next worm moves. Otherwise, each step uses the
+    /// threads of pool in phases:
+    /// 1. Every living worm moves concurrently.
+    /// 2. Every worm of a species that eats carrots that is hungry
+    /// after moving concurrently tries to eat the carrot at its head's
+    /// position. The board is divided
+    /// into horizontal bands, and each band is handled by one task.
+    /// When several heads share a position, the worm with the lowest
+    /// index in getWorms() eats the carrot.
+    /// 3. In order of increasing index, each worm that moved and is
+    /// still alive and was hungry after moving slices or eats a victim
+    /// as described for sliceVictimForWorm() and eatVictimForWorm(),
+    /// and then dies if it is starving. Victims are found at their
+    /// positions after moving, and a victim whose stomach emptied
+    /// while moving has not yet starved. A worm eaten or killed by a
+    /// worm with a lower index does not hunt, and worms created by
+    /// slicing do not move until the next step.
+    /// Pseudo random numbers are drawn on the calling thread in order
+    /// of increasing worm index, so results for a given seed are
+    /// reproducible and do not depend on the number of threads in
+    /// pool. The pool must remain valid until this function is called
+    /// again with a different pool or the simulation is destroyed.
+    void setSteppingThreadPool(
+        WorkStealingThreadPool *pool); //< nullptr or the pool to use
+    
+    //////////////////////////////////////////////////////////////////
+    /// Records every subsequent population event in log: worms being
+    /// created directly or by slicing, slicing and eating other worms,
+    /// and dying of starvation, by being eaten, or by being killed.
+    /// Worms are identified by the generations of their handles, and
+    /// events are stamped with getNumSteps(). If log is nullptr, the
+    /// default, no events are recorded, and the only cost is a test
+    /// of a pointer at each event. Events are recorded only by the
+    /// thread that runs the simulation, even when a stepping thread
+    /// pool is used. The log must remain valid and open until this
+    /// function is called again with a different log or the
+    /// simulation is destroyed.
+    void setEventLog(
+        EventLog *log); //< nullptr or an open log
+    
+    //////////////////////////////////////////////////////////////////
+    /// Records a frame in recording after the screen board is updated
+    /// in every subsequent step. Each frame contains the squares whose
+    /// getOnecAt() or getAttrAt() values changed during the step,
+    /// getNumSteps(), and the number of living worms of each species
+    /// in the order of getSpecies(). If recording is nullptr,
+    /// the default, nothing is recorded. The recording must be open
+    /// for a board of the simulation's dimensions and must remain
+    /// valid and open until this function is called again with a
+    /// different recording or the simulation is destroyed.
+    void setRecording(
+        Recording::writer *recording); //< nullptr or an open recording
     
     //////////////////////////////////////////////////////////////////
     /// Returns the maximum number of rows of squares in a "board"
@@ -209,20 +465,119 @@ public:
 
     /// @name Non-mutating Accessors
     /// @{
-    const std::vector<Worm> &getWorms() const { return m_worms; }
+    const WormStore &getWorms() const { return m_worms; }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns a view of the worm in the slot at index in getWorms().
+    /// The slot may contain a worm that is no longer alive.
+    const Worm getWorm(WormStore::size_type index) const {
+        return Worm(const_cast<WormStore &>(m_worms), index); }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns true iff handle identifies a worm that is still alive.
+    /// Use getWorm(handle.index) to access a living worm.
+    bool isLivingWorm(const worm_handle &handle) const;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns a handle to the living worm with the lowest index in
+    /// getWorms() greater than the index of current, wrapping around
+    /// to index 0 if necessary, or a handle that identifies no worm if
+    /// no worms are alive. Pass a handle that identifies no worm to
+    /// obtain the living worm with the lowest index.
+    worm_handle getNextLivingWorm(const worm_handle &current) const;
+    const Worm::Population &getPopulation() const { return m_population; }
+    
+    /// Returns the registry of the species of the simulation's worms
+    const SpeciesRegistry &getSpecies() const { return *m_species; }
+    const StepProfiler &getProfiler() const { return m_profiler; }
+    const StatisticsCollector &getStatistics() const { return m_statistics; }
     int getWidth() const { return m_actual_board_width; }
     int getHeight() const { return m_actual_board_height; }
     int getHighWaterMark() const { return (int)m_high_water_mark; }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of steps run since the simulation last
+    /// restarted, including steps run before the simulation was saved
+    /// if it was restored by loadSnapshot().
+    std::uint64_t getNumSteps() const { return m_numSteps; }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the number of squares that contain carrots. The time
+    /// taken is proportional to the board's area divided by 64.
+    long getNumCarrots() const { return m_carrots.getCount(); }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the probability per step that a carrot regrows in a
+    /// square that had a carrot when the simulation started and
+    /// contains neither a carrot nor the remains of a dead worm.
+    double getCarrotRegrowthRate() const {
+        return (double)m_carrotRegrowthChance / CarrotLayer::certainRegrowthChance; }
     const char getOnecAt(int x, int y) const {
         assert(x >= 0 && x < getWidth() && y >= 0 && y < getHeight());
-        return m_screen_board[x][y].onec;
+        return m_screen_board.at(x, y).getOnec();
     }
-    const char getAttrAt(int x, int y) const { return m_screen_board[x][y].attr; }
+    const char getAttrAt(int x, int y) const { return m_screen_board.at(x, y).getAttr(); }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns a 64 bit FNV-1a hash of getOnecAt() and getAttrAt()
+    /// for every square. Simulations run with the same seed and the
+    /// same sequence of calls produce identical checksums.
+    std::uint64_t computeBoardChecksum() const;
+    
+    //////////////////////////////////////////////////////////////////
+    /// Writes the complete state of the simulation to a new file at
+    /// path in the format described by Snapshot: the board
+    /// dimensions, a description of every species in getSpecies(),
+    /// the pseudo random number generator, every worm,
+    /// the population, the passive and screen boards, the carrots,
+    /// the carrot regrowth rate, and the number of steps run. Returns
+    /// false if the file could not be written. The thread pool, the
+    /// profiler, the statistics, the event log, and which squares have
+    /// changed since the last display are not saved.
+    bool saveSnapshot(const char *path) const;
+    /// @}
+    
+    /// @name Changes Since the Last Display
+    /// @{
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the set of squares whose getOnecAt() or getAttrAt()
+    /// values may have changed since the last call to
+    /// clearChangedSquares(). User interfaces may redraw only the
+    /// changed squares. When the returned set containsEverything(),
+    /// e.g. after the simulation restarts, every square should be
+    /// redrawn.
+    const PositionSet &getChangedSquares() const { return m_changedSquares; }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Call this function after presenting the changed squares to
+    /// users so that subsequent changes accumulate in an empty set.
+    void clearChangedSquares() { m_changedSquares.clear(); }
     /// @}
     
     /// @name Functions that mutate the simulation
     /// @{
     
+    //////////////////////////////////////////////////////////////////
+    /// Returns the profiler that measures the phases of every step:
+    /// worms living, carrots regrowing, the screen board being
+    /// updated, and the UI strategy redrawing the display and
+    /// processing user input. Enable the profiler to start measuring.
+    StepProfiler &getProfiler() { return m_profiler; }
+    
+    //////////////////////////////////////////////////////////////////
+    /// Returns the collector that samples the simulation after the
+    /// screen board is updated in every step: the number of living
+    /// worms of each species in the order of getSpecies(), the
+    /// total length and stomach contents of living worms, the number
+    /// of carrots, and the number of worms born and died during the
+    /// step. Worms created when the simulation restarts are not
+    /// counted as births. Samples are discarded when the simulation
+    /// restarts or loads a snapshot, and the collector's comma
+    /// separated values are written whenever a run ends. Enable the
+    /// collector to start sampling.
+    StatisticsCollector &getStatistics() { return m_statistics; }
+    
     //////////////////////////////////////////////////////////////////
     /// Each time this function is called, the simulation restarts
     /// from initial conditions with a pseudo random number of
@@ -244,11 +599,66 @@ public:
         AbstractWormsSimUIStrategy &uiStrategy
     );
 
+    //////////////////////////////////////////////////////////////////
+    /// This function is identical to runSimulation(uiStrategy) except
+    /// that the simulation restarts with exactly numWorms generated
+    /// worms.
+    void runSimulation(
+        /// The UI strategy that can be used by the running
+        /// simulation to display simulation state to users and
+        /// accept user input that controls the simulation.
+        AbstractWormsSimUIStrategy &uiStrategy,
+        int numWorms  //< The initial number of worms (must be >= 0)
+    );
+
+    //////////////////////////////////////////////////////////////////
+    /// This function is identical to runSimulation(uiStrategy) except
+    /// that the simulation continues from its current state instead
+    /// of restarting e.g. after loadSnapshot().
+    void continueSimulation(
+        /// The UI strategy that can be used by the running
+        /// simulation to display simulation state to users and
+        /// accept user input that controls the simulation.
+        AbstractWormsSimUIStrategy &uiStrategy
+    );
+    
+    //////////////////////////////////////////////////////////////////
+    /// Replaces the state of the simulation with the state saved in
+    /// the file at path by saveSnapshot(), possibly by a simulation
+    /// with different board dimensions. Snapshots store the index of
+    /// each worm's species, so the simulation must have the same
+    /// species, with the same names, attrs, capacities, food values,
+    /// and behaviors in the same order, as the one that saved the
+    /// snapshot. Continuing the simulation afterwards produces exactly
+    /// the same results as continuing the simulation that saved the
+    /// snapshot. Every square is reported as changed. Returns false
+    /// and leaves the simulation unchanged if the file cannot be read,
+    /// was written by a different version of the format, does not
+    /// contain a consistent simulation, or was saved with species
+    /// other than those of getSpecies().
+    bool loadSnapshot(const char *path);
+
     // Adds a new worm head of a random type of worm at a random
     // position in the simulation's board. As a worm head moves, its
     // following body segments are added to the board automatically.
     void createWorm();
 
+    // If the worm identified by handle is alive, the worm dies and
+    // leaves its remains on the board. Returns true IFF the worm was
+    // killed by this function.
+    bool killWorm(const worm_handle &handle);
+
+    //////////////////////////////////////////////////////////////////
+    /// Sets the probability per step that a carrot regrows in each
+    /// square that had a carrot when the simulation started and
+    /// contains neither a carrot nor the remains of a dead worm. The
+    /// rate is rounded to a multiple of 1/65536, and any rate > 0
+    /// rounds to at least 1/65536. Rate 0, the default, disables
+    /// regrowth. Regrowth consumes pseudo random numbers only when
+    /// enabled, so seeded results without regrowth are unaffected.
+    void setCarrotRegrowthRate(
+        double rate); //< 0.0..1.0
+    
     // This function removes any carrot at x,y, from the simulation.
     // Returns true IFF a carrot was removed by this function.
     bool tryToEatCarrotAt(int x, int y);
@@ -0,0 +1,579 @@
+/*-
+ This program measures the hot functions of the worms simulation in
+ isolation ("micro" benchmarks) and whole simulation steps ("macro"
+ benchmark) for every combination of the requested board sizes and
+ initial numbers of worms:
+
+   Worm::live                      every living worm lives once
+   makeAllWormsLiveConcurrently    every living worm lives once in the
+                                   phases of a step that uses a one
+                                   thread pool
+   WormsSim::getVictimWorm         every living worm looks for a victim
+   updateBoardWithWormsAndCarrots  the screen board is updated after
+                                   every living worm lived once
+   redrawDisplay                   the curses display is redrawn after
+                                   one simulation step
+   redrawDisplay/full              the whole curses display is redrawn
+   runSimulationStep               one complete simulation step
+   saveSnapshot                    the simulation is saved to a file
+   loadSnapshot                    the simulation is restored from a
+                                   file
+
+ Each simulation is first run for a few steps so that measurements
+ start from a typical state rather than from a board full of carrots.
+ Operations that change the simulation run in short batches, and the
+ simulation is restored from a copy before each batch so that worms
+ do not all die while being measured. Restoring and any preparation
+ that an operation needs, e.g. moving worms before the board is
+ updated, are not timed. Each benchmark runs batches until at least
+ --min-time seconds of measured time have accumulated.
+
+ A table of results is printed to stdout. With --json FILE, results
+ are also written to FILE using the JSON layout of the Google
+ Benchmark library so that existing tools can compare runs and track
+ regressions. "items" are worms processed, and the macro benchmark
+ adds steps_per_second and worm_updates_per_second counters.
+
+ The curses display is drawn into a terminal of the board's size
+ whose output is discarded, so no terminal is needed.
+
+ usage: benchmark_suite [--boards WxH[,WxH...]] [--worms N[,N...]]
+                        [--seed X] [--min-time S] [--json FILE]
+*/
+
+#include "Worm.h"
+#include "WormsSim.h"
+#include "HeadlessWormsSimUIStrategy.h"
+#include "CursesWormsSimUIStrategy.h"
+#include "WorkStealingThreadPool.h"
+#include <ncurses.h>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////
+/// WormsSimBenchmarks is a friend of WormsSim so that private steps
+/// of the simulation can be measured in isolation.
+class WormsSimBenchmarks
+{
+public:
+    static void makeAllWormsLive(WormsSim &sim) { sim.makeAllWormsLive(); }
+
+    static void makeAllWormsLiveConcurrently(WormsSim &sim) {
+        sim.makeAllWormsLiveConcurrently(); }
+
+    static Worm getVictimWorm(WormsSim &sim, const Worm &worm,
+        int &out_segmentNumber) {
+        return sim.getVictimWorm(worm, out_segmentNumber); }
+
+    static void updateBoardWithWormsAndCarrots(WormsSim &sim) {
+        sim.updateBoardWithWormsAndCarrots(); }
+
+    static bool runSimulationStep(WormsSim &sim,
+        AbstractWormsSimUIStrategy &uiStrategy) {
+        return sim.runSimulationStep(uiStrategy); }
+};
+
+//////////////////////////////////////////////////////////////////////
+/// One combination of a board size and an initial number of worms
+struct benchmark_case
+{
+    int width;       //< Board width in squares
+    int height;      //< Board height in squares
+    int numWorms;    //< Initial number of worms
+};
+
+//////////////////////////////////////////////////////////////////////
+/// The measurements of one benchmark for one case
+struct benchmark_result
+{
+    std::string name;        //< e.g. "Worm::live/80x24/20"
+    benchmark_case config;   //< The case measured
+    long iterations;         //< Number of timed operations
+    double realNs;           //< Wall clock time of all iterations
+    double cpuNs;            //< Process CPU time of all iterations
+    long long items;         //< Worms processed by all iterations
+    long long wormUpdates;   //< Living worms after each step (macro only)
+};
+
+//////////////////////////////////////////////////////////////////////
+/// The parts of one benchmark. Every function except operation may
+/// be empty.
+struct benchmark_definition
+{
+    /// Untimed: called before each batch to reset the simulation
+    std::function<void()> restore;
+
+    /// Untimed: called before each iteration
+    std::function<void()> prepare;
+
+    /// Timed: returns the number of worms processed
+    std::function<long()> operation;
+};
+
+/// The number of iterations between restores of the simulation
+static const int iterationsPerBatch = 16;
+
+/// The number of steps run before measurements start
+static const long numWarmUpSteps = 50;
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the CPU time used by the process in nanoseconds.
+static double cpuNow()
+{
+    timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Returns steady wall clock time in nanoseconds.
+static double realNow()
+{
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Runs batches of the operation of definition until at least
+/// minimumSeconds of timed work has accumulated and returns the
+/// accumulated measurements.
+static benchmark_result runBenchmark(
+    const std::string &name,
+    const benchmark_case &config,
+    const benchmark_definition &definition,
+    double minimumSeconds)
+{
+    benchmark_result result = {name, config, 0, 0.0, 0.0, 0, 0};
+
+    while(result.realNs < minimumSeconds * 1e9 || 0 == result.iterations)
+    {
+        if(definition.restore) { definition.restore(); }
+
+        if(!definition.prepare)
+        {
+            const double realStart = realNow();
+            const double cpuStart = cpuNow();
+            for(int i = 0; i < iterationsPerBatch; ++i)
+            {
+                result.items += definition.operation();
+            }
+            result.cpuNs += cpuNow() - cpuStart;
+            result.realNs += realNow() - realStart;
+        }
+        else
+        {
+            for(int i = 0; i < iterationsPerBatch; ++i)
+            {
+                definition.prepare();
+                const double realStart = realNow();
+                const double cpuStart = cpuNow();
+                result.items += definition.operation();
+                result.cpuNs += cpuNow() - cpuStart;
+                result.realNs += realNow() - realStart;
+            }
+        }
+        result.iterations += iterationsPerBatch;
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the number of living worms in sim.
+static long countLivingWorms(const WormsSim &sim)
+{
+    return sim.getPopulation().getNumLiving();
+}
+
+/// The curses terminal whose output is discarded or nullptr if it has
+/// not been created. See startDiscardedCurses().
+static SCREEN *discardedScreen = nullptr;
+
+//////////////////////////////////////////////////////////////////////
+/// Prepares curses to draw into a terminal with the specified
+/// dimensions whose output is discarded. Returns false if curses
+/// could not be prepared.
+static bool startDiscardedCurses(int width, int height)
+{
+    if(nullptr == discardedScreen)
+    {
+        FILE *discard = fopen("/dev/null", "w");
+        const char *terminalType = getenv("TERM");
+        if(nullptr != discard)
+        {
+            discardedScreen = newterm((nullptr != terminalType && '\0' !=
+                terminalType[0]) ? terminalType : "xterm", discard, stdin);
+            if(nullptr == discardedScreen)
+            {
+                discardedScreen = newterm("xterm", discard, stdin);
+            }
+        }
+        if(nullptr == discardedScreen)
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        set_term(discardedScreen);
+        typeahead(-1); // never poll stdin for typed characters
+        start_color();
+    }
+
+    return OK == resizeterm(height, width);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Runs every benchmark for config and appends the results to
+/// out_results.
+static void runCase(
+    const benchmark_case &config,
+    std::uint64_t seed,
+    double minimumSeconds,
+    std::vector<benchmark_result> &out_results)
+{
+    const std::string suffix = "/" + std::to_string(config.width) + "x" +
+        std::to_string(config.height) + "/" + std::to_string(config.numWorms);
+
+    WormsSim prototype(config.width, config.height);
+    prototype.seedRandomNumbers(seed);
+    HeadlessWormsSimUIStrategy warmUpStrategy(prototype, numWarmUpSteps);
+    prototype.runSimulation(warmUpStrategy, config.numWorms);
+    prototype.clearChangedSquares();
+
+    WormsSim sim(prototype);
+    const std::function<void()> restore = [&]() { sim = prototype; };
+
+    benchmark_definition live;
+    live.restore = restore;
+    live.operation = [&]() {
+        const long numLiving = countLivingWorms(sim);
+        WormsSimBenchmarks::makeAllWormsLive(sim);
+        return numLiving; };
+    out_results.push_back(runBenchmark("Worm::live" + suffix, config,
+        live, minimumSeconds));
+
+    // A pool with one thread measures the cost of stepping in phases
+    // without the speedup of additional threads
+    WorkStealingThreadPool steppingPool(1);
+    benchmark_definition phased;
+    phased.restore = [&]() {
+        sim = prototype;
+        sim.setSteppingThreadPool(&steppingPool); };
+    phased.operation = [&]() {
+        const long numLiving = countLivingWorms(sim);
+        WormsSimBenchmarks::makeAllWormsLiveConcurrently(sim);
+        return numLiving; };
+    out_results.push_back(runBenchmark(
+        "WormsSim::makeAllWormsLiveConcurrently" + suffix, config,
+        phased, minimumSeconds));
+
+    // Looking for victims changes nothing, so no restore is needed
+    sim = prototype;
+    benchmark_definition victim;
+    volatile int victimSegmentSum = 0;
+    victim.operation = [&]() {
+        long numLiving = 0;
+        for(WormStore::size_type i = 0; i < sim.getWorms().size(); ++i)
+        {
+            const Worm worm(sim.getWorm(i));
+            if(worm.isAlive())
+            {
+                int segmentNumber = 0;
+                WormsSimBenchmarks::getVictimWorm(sim, worm, segmentNumber);
+                victimSegmentSum += segmentNumber;
+                numLiving += 1;
+            }
+        }
+        return numLiving; };
+    out_results.push_back(runBenchmark("WormsSim::getVictimWorm" + suffix,
+        config, victim, minimumSeconds));
+
+    benchmark_definition update;
+    update.restore = restore;
+    update.prepare = [&]() {
+        WormsSimBenchmarks::makeAllWormsLive(sim);
+        sim.clearChangedSquares(); };
+    update.operation = [&]() {
+        WormsSimBenchmarks::updateBoardWithWormsAndCarrots(sim);
+        return countLivingWorms(sim); };
+    out_results.push_back(runBenchmark(
+        "WormsSim::updateBoardWithWormsAndCarrots" + suffix, config,
+        update, minimumSeconds));
+
+    static const int rowsInMessageArea = 5; //< As in the curses program
+    if(startDiscardedCurses(config.width, config.height + rowsInMessageArea))
+    {
+        sim = prototype;
+        CursesWormsSimUIStrategy cursesStrategy(sim);
+        cursesStrategy.setMaxFramesPerSecond(0.0); // Draw every frame
+        cursesStrategy.redrawDisplay();
+
+        benchmark_definition redraw;
+        redraw.restore = restore;
+        redraw.prepare = [&]() {
+            WormsSimBenchmarks::makeAllWormsLive(sim);
+            WormsSimBenchmarks::updateBoardWithWormsAndCarrots(sim); };
+        redraw.operation = [&]() {
+            cursesStrategy.redrawDisplay();
+            return countLivingWorms(sim); };
+        out_results.push_back(runBenchmark(
+            "CursesWormsSimUIStrategy::redrawDisplay" + suffix, config,
+            redraw, minimumSeconds));
+
+        benchmark_definition fullRedraw;
+        fullRedraw.restore = restore;
+        fullRedraw.prepare = [&]() { cursesStrategy.requestFullRedraw(); };
+        fullRedraw.operation = [&]() {
+            cursesStrategy.redrawDisplay();
+            return countLivingWorms(sim); };
+        out_results.push_back(runBenchmark(
+            "CursesWormsSimUIStrategy::redrawDisplay/full" + suffix, config,
+            fullRedraw, minimumSeconds));
+    }
+    else
+    {
+        fprintf(stderr, "curses is unavailable: redrawDisplay%s skipped\n",
+            suffix.c_str());
+    }
+
+    // The strategy never ends the simulation. Living worms are
+    // counted after each step the same way the headless program
+    // counts worm-steps.
+    sim = prototype;
+    HeadlessWormsSimUIStrategy stepStrategy(sim,
+        std::numeric_limits<long>::max());
+    benchmark_definition step;
+    step.restore = restore;
+    step.operation = [&]() {
+        WormsSimBenchmarks::runSimulationStep(sim, stepStrategy);
+        return countLivingWorms(sim); };
+    benchmark_result stepResult(runBenchmark(
+        "WormsSim::runSimulationStep" + suffix, config, step,
+        minimumSeconds));
+    stepResult.wormUpdates = stepResult.items;
+    out_results.push_back(stepResult);
+
+    // Snapshots are written to a temporary file in the current
+    // directory, which is removed afterwards
+    static const char *snapshotPath = "benchmark_suite.snapshot";
+    sim = prototype;
+    benchmark_definition save;
+    save.operation = [&]() {
+        sim.saveSnapshot(snapshotPath);
+        return countLivingWorms(sim); };
+    out_results.push_back(runBenchmark("WormsSim::saveSnapshot" + suffix,
+        config, save, minimumSeconds));
+
+    benchmark_definition load;
+    load.operation = [&]() {
+        sim.loadSnapshot(snapshotPath);
+        return countLivingWorms(sim); };
+    out_results.push_back(runBenchmark("WormsSim::loadSnapshot" + suffix,
+        config, load, minimumSeconds));
+    std::remove(snapshotPath);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Writes results to file using the JSON layout of the Google
+/// Benchmark library.
+static void writeJson(
+    std::FILE *file,
+    const char *programName,
+    const std::vector<benchmark_result> &results)
+{
+    char date[64];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z",
+        std::localtime(&now));
+
+    std::fprintf(file, "{\n  \"context\": {\n"
+        "    \"date\": \"%s\",\n"
+        "    \"executable\": \"%s\",\n"
+        "    \"num_cpus\": %u,\n"
+#ifdef NDEBUG
+        "    \"library_build_type\": \"release\"\n"
+#else
+        "    \"library_build_type\": \"debug\"\n"
+#endif
+        "  },\n  \"benchmarks\": [",
+        date, programName, std::thread::hardware_concurrency());
+
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+        const benchmark_result &r(results[i]);
+        const double seconds = r.realNs * 1e-9;
+        std::fprintf(file, "%s\n    {\n"
+            "      \"name\": \"%s\",\n"
+            "      \"run_name\": \"%s\",\n"
+            "      \"run_type\": \"iteration\",\n"
+            "      \"iterations\": %ld,\n"
+            "      \"real_time\": %.3f,\n"
+            "      \"cpu_time\": %.3f,\n"
+            "      \"time_unit\": \"ns\",\n"
+            "      \"board_width\": %d,\n"
+            "      \"board_height\": %d,\n"
+            "      \"initial_worms\": %d,\n"
+            "      \"items_per_second\": %.3f",
+            (0 == i) ? "" : ",",
+            r.name.c_str(), r.name.c_str(), r.iterations,
+            r.realNs / r.iterations, r.cpuNs / r.iterations,
+            r.config.width, r.config.height, r.config.numWorms,
+            r.items / seconds);
+        if(0 < r.wormUpdates)
+        {
+            std::fprintf(file, ",\n"
+                "      \"steps_per_second\": %.3f,\n"
+                "      \"worm_updates_per_second\": %.3f",
+                r.iterations / seconds, r.wormUpdates / seconds);
+        }
+        std::fprintf(file, "\n    }");
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Prints a description of the command line arguments to stderr.
+static void printUsage(const char *programName)
+{
+    fprintf(stderr,
+        "usage: %s [--boards WxH[,WxH...]] [--worms N[,N...]] "
+        "[--seed X] [--min-time S] [--json FILE]\n"
+        "  --boards WxH,...  board sizes (default 80x24,300x200,1000x1000)\n"
+        "  --worms N,...     initial numbers of worms (default 20,500)\n"
+        "  --seed X          random number seed (default 1)\n"
+        "  --min-time S      measured seconds per benchmark (default 0.2)\n"
+        "  --json FILE       also write results to FILE as JSON\n",
+        programName);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Parses a comma separated list of positive numbers or, if
+/// isParsingSizes, WxH pairs into out_values. Sizes are stored as
+/// consecutive width and height values. Returns false if text is
+/// not such a list.
+static bool parseList(const char *text, bool isParsingSizes,
+    std::vector<long> &out_values)
+{
+    out_values.clear();
+    const char *p = text;
+    do
+    {
+        char *end = nullptr;
+        out_values.push_back(strtol(p, &end, 10));
+        if(end == p || out_values.back() < 1)
+        {   // !!!! EARLY EXIT !!!!
+            return false;
+        }
+        p = end;
+        if(isParsingSizes)
+        {
+            if('x' != *p)
+            {   // !!!! EARLY EXIT !!!!
+                return false;
+            }
+            ++p;
+            out_values.push_back(strtol(p, &end, 10));
+            if(end == p || out_values.back() < 1)
+            {   // !!!! EARLY EXIT !!!!
+                return false;
+            }
+            p = end;
+        }
+    } while(',' == *p++);
+
+    return '\0' == p[-1];
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<long> sizes = {80, 24, 300, 200, 1000, 1000};
+    std::vector<long> wormCounts = {20, 500};
+    long seed = 1;
+    double minimumSeconds = 0.2;
+    const char *jsonPath = nullptr;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        bool isValid = i + 1 < argc;
+        if(isValid && 0 == strcmp(argv[i], "--boards"))
+        {
+            isValid = parseList(argv[++i], true, sizes);
+        }
+        else if(isValid && 0 == strcmp(argv[i], "--worms"))
+        {
+            isValid = parseList(argv[++i], false, wormCounts);
+        }
+        else if(isValid && 0 == strcmp(argv[i], "--seed"))
+        {
+            char *end = nullptr;
+            seed = strtol(argv[++i], &end, 10);
+            isValid = '\0' == *end && 0 <= seed;
+        }
+        else if(isValid && 0 == strcmp(argv[i], "--min-time"))
+        {
+            char *end = nullptr;
+            minimumSeconds = strtod(argv[++i], &end);
+            isValid = '\0' == *end && 0.0 < minimumSeconds;
+        }
+        else if(isValid && 0 == strcmp(argv[i], "--json"))
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            isValid = false;
+        }
+
+        if(!isValid)
+        {   // !!!! EARLY EXIT !!!!
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<benchmark_result> results;
+    printf("%-56s %12s %14s %14s\n", "benchmark", "iterations",
+        "ns/iteration", "ns/worm");
+    for(std::size_t s = 0; s + 1 < sizes.size(); s += 2)
+    {
+        for(long numWorms : wormCounts)
+        {
+            const benchmark_case config = {
+                (int)sizes[s], (int)sizes[s + 1], (int)numWorms};
+            const std::size_t firstResult = results.size();
+            runCase(config, (std::uint64_t)seed, minimumSeconds, results);
+            for(std::size_t i = firstResult; i < results.size(); ++i)
+            {
+                const benchmark_result &r(results[i]);
+                printf("%-56s %12ld %14.1f %14.2f\n", r.name.c_str(),
+                    r.iterations, r.realNs / r.iterations,
+                    (0 < r.items) ? r.realNs / r.items : 0.0);
+            }
+            fflush(stdout);
+        }
+    }
+    if(nullptr != discardedScreen) { endwin(); }
+
+    if(nullptr != jsonPath)
+    {
+        std::FILE *file = std::fopen(jsonPath, "w");
+        if(nullptr == file)
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", jsonPath);
+            return 1;
+        }
+        writeJson(file, argv[0], results);
+        std::fclose(file);
+    }
+
+    return 0;
+}
+
+/* -eof- */
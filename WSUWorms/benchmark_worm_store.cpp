@@ -0,0 +1,306 @@
+/*-
+ This program measures how quickly the segments of many worms can be
+ visited and moved when they are stored in a WormStore compared with
+ the layout the store replaced, in which each worm owned a separately
+ allocated vector of {int x, int y, char c} segments.
+
+ Both layouts contain the same worms. The separately allocated
+ vectors are allocated in a shuffled order to resemble a heap after
+ many worms have died and been replaced. Each operation is repeated
+ and the fastest repetition is reported.
+
+ The difference is caused by cache misses. To count them directly,
+ run e.g. "perf stat -e cache-misses,cache-references
+ ./benchmark_worm_store" once with each layout selected using
+ --only-store or --only-vectors.
+
+ usage: benchmark_worm_store [--worms N] [--seed X]
+                             [--only-store | --only-vectors]
+*/
+
+#include "Worm.h"
+#include "WormsSim.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+
+//////////////////////////////////////////////////////////////////////
+/// The worm layout replaced by WormStore: every worm owns a vector of
+/// padded segment records that is allocated independently of the
+/// vectors of other worms.
+struct vector_worm
+{
+    /// One padded segment record
+    struct segment
+    {
+        int x, y;    //< coordinates of the segment
+        char c;      //< the letter carried
+    };
+
+    std::vector<segment> segments; //< Circular buffer of segments
+    unsigned int mask;             //< capacity of segments - 1
+    unsigned int tailSerial;       //< serial number of segment index 0
+    unsigned int length;           //< number of segments
+    int direction;                 //< The (head's) direction
+    int stomach;                   //< Food value
+    int capacity;                  //< Food storable per segment
+    bool isAlive;                  //< == true iff the worm is alive
+};
+
+/// The number of repetitions of each measured operation
+static const int numRepetitions = 20;
+
+//////////////////////////////////////////////////////////////////////
+/// Calls operation() numRepetitions times and returns the fastest
+/// time in nanoseconds.
+template <typename T>
+static double timeFastest(const T &operation)
+{
+    double fastest = 0.0;
+    for(int i = 0; i < numRepetitions; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        operation();
+        const double elapsed = std::chrono::duration<double, std::nano>(
+            std::chrono::steady_clock::now() - start).count();
+        if(0 == i || elapsed < fastest) { fastest = elapsed; }
+    }
+    return fastest;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Copies every worm in sim into a vector_worm. The segment vectors
+/// are allocated in a shuffled order.
+static std::vector<vector_worm> copyWorms(
+    const WormsSim &sim, std::mt19937 &generator)
+{
+    std::vector<vector_worm> result(sim.getWorms().size());
+
+    std::vector<WormStore::size_type> order(result.size());
+    for(WormStore::size_type i = 0; i < order.size(); ++i) { order[i] = i; }
+    std::shuffle(order.begin(), order.end(), generator);
+
+    for(WormStore::size_type index : order)
+    {
+        const Worm worm(sim.getWorm(index));
+        vector_worm &copy(result[index]);
+
+        copy.length = (unsigned int)worm.getBody().size();
+        unsigned int capacity = 1;
+        while(capacity < copy.length) { capacity <<= 1; }
+        copy.segments.resize(capacity);
+        copy.mask = capacity - 1;
+        copy.tailSerial = worm.getTailSerial();
+        copy.direction = 0;
+        // The amounts of food only need to be plausible
+        copy.stomach = worm.getFoodValue();
+        copy.capacity = copy.stomach / (int)copy.length;
+        copy.isAlive = worm.isAlive();
+        for(unsigned int i = 0; i < copy.length; ++i)
+        {
+            const Worm::segment s(worm.getBody()[i]);
+            const vector_worm::segment v = {s.getX(), s.getY(), s.getC()};
+            copy.segments[(copy.tailSerial + i) & copy.mask] = v;
+        }
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Returns a value that depends on every segment of every worm in
+/// sim, visiting segments the way the simulation does when drawing
+/// worms.
+static long sumStoredSegments(const WormsSim &sim)
+{
+    long sum = 0;
+    for(WormStore::size_type i = 0; i < sim.getWorms().size(); ++i)
+    {
+        const Worm worm(sim.getWorm(i));
+        for(const Worm::segment &s : worm.getBody())
+        {
+            sum += s.getX() * 7 + s.getY() * 3 + s.getC();
+        }
+    }
+    return sum;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Returns the same value as sumStoredSegments() for the copies of
+/// the worms in worms.
+static long sumVectorSegments(const std::vector<vector_worm> &worms)
+{
+    long sum = 0;
+    for(const vector_worm &worm : worms)
+    {
+        for(unsigned int i = 0; i < worm.length; ++i)
+        {
+            const vector_worm::segment &s(
+                worm.segments[(worm.tailSerial + i) & worm.mask]);
+            sum += s.x * 7 + s.y * 3 + s.c;
+        }
+    }
+    return sum;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Moves every worm in worms one square in its current direction the
+/// same way Worm::move() moves worms in a WormStore and returns the
+/// number of hungry worms.
+static int moveVectorWorms(
+    std::vector<vector_worm> &worms, int width, int height)
+{
+    int numHungry = 0;
+    static const int dxa[8] = { +0, +1, +1, +1, +0, -1, -1, -1 };
+    static const int dya[8] = { -1, -1, +0, +1, +1, +1, +0, -1 };
+
+    for(vector_worm &worm : worms)
+    {
+        const vector_worm::segment &head(worm.segments[
+            (worm.tailSerial + worm.length - 1) & worm.mask]);
+        vector_worm::segment newHead = {
+            (head.x + dxa[worm.direction] + width) % width,
+            (head.y + dya[worm.direction] + height) % height,
+            head.c};
+        worm.segments[(worm.tailSerial + worm.length) & worm.mask] = newHead;
+        worm.tailSerial += 1;
+
+        const int n = (int)worm.length * worm.capacity;
+        worm.stomach = std::min(n, worm.stomach) - 1;
+        if(worm.isAlive && 4 * worm.stomach < 3 * n) { ++numHungry; }
+    }
+    return numHungry;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Prints a description of the command line arguments to stderr.
+static void printUsage(const char *programName)
+{
+    fprintf(stderr,
+        "usage: %s [--worms N] [--seed X] [--only-store | --only-vectors]\n"
+        "  --worms N       number of worms (default 50000)\n"
+        "  --seed X        random number seed (default 1)\n"
+        "  --only-store    measure only the WormStore layout\n"
+        "  --only-vectors  measure only the separate vectors layout\n",
+        programName);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Stores the value of the argument following argv[i] in out_value
+/// and advances i past it. Returns false if there is no following
+/// argument or the following argument is not a number >= minimum.
+static bool parseNumberArgument(
+    int argc, char *argv[], int &i, long minimum, long &out_value)
+{
+    if(i + 1 >= argc)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    char *end = nullptr;
+    out_value = strtol(argv[i + 1], &end, 10);
+    i += 1;
+
+    return '\0' == *end && end != argv[i] && out_value >= minimum;
+}
+
+int main(int argc, char *argv[])
+{
+    long numWorms = 50000;
+    long seed = 1;
+    bool isMeasuringStore = true;
+    bool isMeasuringVectors = true;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        bool isValid = true;
+        if(0 == strcmp(argv[i], "--worms"))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1, numWorms);
+        }
+        else if(0 == strcmp(argv[i], "--seed"))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 0, seed);
+        }
+        else if(0 == strcmp(argv[i], "--only-store"))
+        {
+            isMeasuringVectors = false;
+        }
+        else if(0 == strcmp(argv[i], "--only-vectors"))
+        {
+            isMeasuringStore = false;
+        }
+        else
+        {
+            isValid = false;
+        }
+
+        if(!isValid)
+        {   // !!!! EARLY EXIT !!!!
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Worms are spread over a board large enough that they rarely
+    // overlap. They never live, so the board is never drawn.
+    static const int width = 2000;
+    static const int height = 2000;
+    WormsSim sim(width, height);
+    sim.seedRandomNumbers((std::uint64_t)seed);
+    for(long i = 0; i < numWorms; ++i) { sim.createWorm(); }
+
+    std::mt19937 generator((std::mt19937::result_type)seed);
+    std::vector<vector_worm> vectorWorms(copyWorms(sim, generator));
+
+    long numSegments = 0;
+    std::size_t vectorBytes = 0;
+    for(const vector_worm &worm : vectorWorms)
+    {
+        numSegments += worm.length;
+        vectorBytes += worm.segments.capacity() * sizeof(vector_worm::segment);
+    }
+    const std::size_t storeBytes = sim.getWorms().getSegmentCapacity() *
+        (sizeof(WormStore::position) + sizeof(char));
+
+    printf("%ld worms, %ld segments\n", numWorms, numSegments);
+    printf("%-18s %14s %16s %14s\n",
+        "layout", "bytes/segment", "visit ns/segment", "move ns/worm");
+
+    if(isMeasuringStore)
+    {
+        volatile long sum = 0;
+        const double visitNs = timeFastest([&]() {
+            sum = sumStoredSegments(sim); });
+        const double moveNs = timeFastest([&]() {
+            int numHungry = 0;
+            for(WormStore::size_type i = 0; i < sim.getWorms().size(); ++i)
+            {
+                Worm worm(const_cast<WormStore &>(sim.getWorms()), i);
+                if(worm.move(0, sim)) { ++numHungry; }
+            }
+            sum = numHungry; });
+        printf("%-18s %14.2f %16.3f %14.3f\n", "WormStore",
+            (double)storeBytes / numSegments, visitNs / numSegments,
+            moveNs / numWorms);
+    }
+
+    if(isMeasuringVectors)
+    {
+        volatile long sum = 0;
+        const double visitNs = timeFastest([&]() {
+            sum = sumVectorSegments(vectorWorms); });
+        const double moveNs = timeFastest([&]() {
+            sum = moveVectorWorms(vectorWorms, width, height); });
+        printf("%-18s %14.2f %16.3f %14.3f\n", "separate vectors",
+            (double)vectorBytes / numSegments, visitNs / numSegments,
+            moveNs / numWorms);
+    }
+
+    return 0;
+}
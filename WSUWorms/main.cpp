@@ -12,19 +12,123 @@
 #include "Worm.h"
 #include "WormsSim.h"
 #include "CursesWormsSimUIStrategy.h"
+#include "CursesReplayUIStrategy.h"
+#include "Recording.h"
+#include <cstdio>
+#include <cstring>
+
+
+//////////////////////////////////////////////////////////////////////
+/// Plays the recording at path in the display until the user presses
+/// ESC. Returns the program's exit status.
+static int replay(const char *path, double framesPerSecond)
+{
+    Recording::player player(path);
+    if(!player.isValid())
+    {   // !!!! EARLY EXIT !!!!
+        fprintf(stderr, "unable to read recording %s\n", path);
+        return 1;
+    }
+    
+    int displayWidth, displayHeight;
+    CursesWormsSimUIStrategy::initializeForDisplay(
+        displayWidth, displayHeight);
+    
+    CursesReplayUIStrategy replayStrategy(player);
+    replayStrategy.setTargetFramesPerSecond(framesPerSecond);
+    replayStrategy.run();
+    CursesWormsSimUIStrategy::releaseDisplay();
+    
+    return 0;
+}
 
 
 int main(int argc, char * argv[])
 {
-    int slowness = std::max(0, 10*(argc > 1? argv[1][0] - '0' : 1));
+    // Optional leading arguments "--record FILE" record every step in
+    // FILE, "--replay FILE" plays a recording instead of running a
+    // simulation, and "--species FILE" creates worms of the species
+    // described in FILE. See Recording and SpeciesRegistry.
+    const char *recordingPath = nullptr;
+    const char *replayPath = nullptr;
+    const char *speciesPath = nullptr;
+    for(bool isOption = true; isOption && argc > 2; )
+    {
+        if(0 == strcmp("--record", argv[1])) { recordingPath = argv[2]; }
+        else if(0 == strcmp("--replay", argv[1])) { replayPath = argv[2]; }
+        else if(0 == strcmp("--species", argv[1])) { speciesPath = argv[2]; }
+        else { isOption = false; }
+        
+        if(isOption)
+        {
+            argc -= 2;
+            argv += 2;
+        }
+    }
+    
+    SpeciesRegistry species(nullptr != speciesPath ? speciesPath : "");
+    int errorLine = 0;
+    if(nullptr != speciesPath && !species.loadFromFile(speciesPath, errorLine))
+    {   // !!!! EARLY EXIT !!!!
+        fprintf(stderr, "unable to read species %s line %d\n",
+            speciesPath, errorLine);
+        return 1;
+    }
+    
+    // An optional first argument digit d selects 100/d steps per
+    // second, and 0 selects as many steps per second as possible
+    const int slowness = std::max(0, (argc > 1? argv[1][0] - '0' : 1));
+    const double stepsPerSecond = (0 == slowness) ? 0.0 : 100.0 / slowness;
+    
+    if(nullptr != replayPath)
+    {   // !!!! EARLY EXIT !!!!
+        return replay(replayPath, stepsPerSecond);
+    }
+    
     int displayWidth, displayHeight;
     
     CursesWormsSimUIStrategy::initializeForDisplay(
         displayWidth, displayHeight);
     
-    WormsSim &sim(WormsSim::initSingletonSim(displayWidth, displayHeight));
+    WormsSim sim(displayWidth, displayHeight, (nullptr != speciesPath) ?
+        species : SpeciesRegistry::getDefault());
     CursesWormsSimUIStrategy uiStrategy(sim);
-    uiStrategy.setSlowness(slowness);
+    uiStrategy.setTargetStepsPerSecond(stepsPerSecond);
+    
+    // The recording can only be opened once the display determines
+    // the board size, so the display is released before reporting
+    Recording::writer recording;
+    if(nullptr != recordingPath)
+    {
+        if(!recording.open(recordingPath,
+            sim.getWidth(), sim.getHeight(), sim.getSpecies().size(),
+            Recording::defaultKeyframeInterval))
+        {   // !!!! EARLY EXIT !!!!
+            CursesWormsSimUIStrategy::releaseDisplay();
+            fprintf(stderr, "unable to write %s\n", recordingPath);
+            return 1;
+        }
+        sim.setRecording(&recording);
+    }
+    
+    // An optional second argument names a file to which the timing of
+    // the phases of steps is written as comma separated values
+    std::FILE *profileFile = (argc > 2) ? std::fopen(argv[2], "w") : nullptr;
+    if(nullptr != profileFile)
+    {
+        sim.getProfiler().setCsvOutput(profileFile);
+        sim.getProfiler().setEnabled(true);
+    }
+    
+    // An optional third argument names a file to which the statistics
+    // kept during each run are written as comma separated values when
+    // the run ends
+    sim.getStatistics().setEnabled(true);
+    std::FILE *statisticsFile = (argc > 3) ? std::fopen(argv[3], "w") : nullptr;
+    if(nullptr != statisticsFile)
+    {
+        sim.getStatistics().setCsvOutput(statisticsFile);
+    }
     
     for (bool shouldExit = false; !shouldExit; )
     {
@@ -33,6 +137,24 @@ int main(int argc, char * argv[])
     }
     uiStrategy.releaseDisplay();
     
+    sim.setRecording(nullptr);
+    if(!recording.close())
+    {
+        fprintf(stderr, "unable to write recording %s\n", recordingPath);
+    }
+    
+    if(nullptr != profileFile)
+    {
+        sim.getProfiler().setCsvOutput(nullptr);
+        std::fclose(profileFile);
+    }
+    
+    if(nullptr != statisticsFile)
+    {
+        sim.getStatistics().setCsvOutput(nullptr);
+        std::fclose(statisticsFile);
+    }
+    
     return 0;
 }
 
@@ -0,0 +1,629 @@
+/*-
+ This program runs the worms simulation without any display or user
+ input so that many simulations can be run quickly e.g. on machines
+ without a terminal. Final populations and timing statistics are
+ printed to standard output.
+
+ When more than one run is requested, runs execute in parallel on all
+ cores, run i uses seed X+i, and a table of comma separated results
+ with one row per run is printed instead.
+
+ A single run may instead update its worms concurrently using the
+ number of threads given by --step-threads. See
+ WormsSim::setSteppingThreadPool().
+
+ --count-allocations additionally prints, for a single run, the number
+ of heap allocations made during the second half of the steps and
+ statistics about the storage of worm segments. A run that has
+ reached a steady state should make no heap allocations.
+
+ --profile-csv FILE writes the time spent in each phase of a single
+ run's steps and counts of work done to FILE as comma separated values
+ with one row per --profile-every N steps. A summary is also printed.
+
+ --stats-csv FILE samples the populations, total worm length and
+ stomach contents, carrots, births, and deaths of a single run after
+ every step and writes the last --stats-history N samples to FILE as
+ comma separated values when the run ends. The samples are kept in
+ ring buffers of N elements allocated when the run starts, so N
+ defaults to StatisticsCollector::defaultCapacity rather than to the
+ number of steps, and exporting every step of a long run requires
+ raising --stats-history explicitly. See WormsSim::getStatistics().
+
+ --carrot-regrowth P lets carrots regrow in each eaten square with
+ probability P per step so that Vegetarians need not starve once the
+ initial carrots are gone. See WormsSim::setCarrotRegrowthRate().
+
+ --load-snapshot FILE continues a single run from the state saved in
+ FILE instead of starting a new simulation, so the board size, number
+ of worms, pseudo random number state, and carrot regrowth rate of the
+ saved simulation are used, and --seed is ignored. The summary then
+ names the snapshot instead of a seed. --save-snapshot FILE saves the
+ state of a single run to FILE after its last step. Running S steps,
+ saving, loading, and running T more steps produces the same board as
+ running S + T steps. See WormsSim::saveSnapshot().
+
+ --event-log FILE records every birth, slice, eat, and death of a
+ single run in FILE in the compact format described by EventLog.
+ --print-event-log FILE prints the events recorded in FILE as comma
+ separated values instead of running a simulation.
+
+ --record FILE records what the board of a single run shows after
+ every step in FILE so that the run can be replayed with
+ "worms --replay FILE". See Recording.
+
+ --species FILE creates worms of the species described in FILE instead
+ of Vegetarians, Scissor-heads, and Cannibals. See SpeciesRegistry.
+ --species may be repeated to compare sets of species in one batch:
+ run i uses the (i mod number of sets)th set. A single run uses the
+ first set.
+
+ usage: worms_headless [--width W] [--height H] [--worms N]
+                       [--steps S] [--seed X] [--runs R]
+                       [--threads T] [--step-threads T]
+                       [--carrot-regrowth P]
+                       [--load-snapshot FILE] [--save-snapshot FILE]
+                       [--event-log FILE] [--print-event-log FILE]
+                       [--record FILE] [--species FILE]...
+                       [--profile-csv FILE] [--profile-every N]
+                       [--stats-csv FILE] [--stats-history N]
+                       [--stop-at-extinction] [--count-allocations]
+*/
+
+#include "Worm.h"
+#include "WormsSim.h"
+#include "HeadlessWormsSimUIStrategy.h"
+#include "SimulationBatch.h"
+#include "WorkStealingThreadPool.h"
+#include "HeapAllocationCounter.h"
+#include "EventLog.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+
+//////////////////////////////////////////////////////////////////////
+/// Prints a description of the command line arguments to stderr.
+static void printUsage(const char *programName)
+{
+    fprintf(stderr,
+        "usage: %s [--width W] [--height H] [--worms N] [--steps S] "
+        "[--seed X] [--runs R] [--threads T] [--step-threads T] "
+        "[--carrot-regrowth P] [--load-snapshot FILE] [--save-snapshot FILE] "
+        "[--event-log FILE] [--print-event-log FILE] [--record FILE] "
+        "[--species FILE]... "
+        "[--profile-csv FILE] [--profile-every N] "
+        "[--stats-csv FILE] [--stats-history N] "
+        "[--stop-at-extinction] [--count-allocations]\n"
+        "  --width W   board width in squares (default 80)\n"
+        "  --height H  board height in squares (default 24)\n"
+        "  --worms N   initial number of worms (default 6)\n"
+        "  --steps S   number of simulation steps (default 1000)\n"
+        "  --seed X    random number seed (default: nondeterministic)\n"
+        "  --runs R    number of independent runs (default 1)\n"
+        "  --threads T worker threads for runs (default: all cores)\n"
+        "  --step-threads T  update the worms of a single run using T\n"
+        "              threads (default 0: update worms one at a time)\n"
+        "  --carrot-regrowth P  probability 0..1 that a carrot regrows\n"
+        "              in each eaten square per step (default 0)\n"
+        "  --load-snapshot FILE  continue the simulation saved in FILE\n"
+        "  --save-snapshot FILE  save the simulation to FILE at the end\n"
+        "  --event-log FILE  record births, slices, eats, and deaths\n"
+        "              of a single run in FILE\n"
+        "  --print-event-log FILE  print the events in FILE as comma\n"
+        "              separated values and exit\n"
+        "  --record FILE  record the board after every step of a single\n"
+        "              run in FILE for replay\n"
+        "  --species FILE  create worms of the species described in FILE;\n"
+        "              repeat to alternate sets of species between runs\n"
+        "  --profile-csv FILE  write per-phase timing of a single run\n"
+        "              to FILE as comma separated values\n"
+        "  --profile-every N  steps per row of --profile-csv (default 100)\n"
+        "  --stats-csv FILE  write populations and totals of a single run\n"
+        "              after every step to FILE as comma separated values\n"
+        "  --stats-history N  steps written by --stats-csv, counting\n"
+        "              back from the last (default 1000)\n"
+        "  --stop-at-extinction  end each run when all worms are dead\n"
+        "  --count-allocations  print heap allocations made during the\n"
+        "              second half of a single run\n",
+        programName);
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Stores the value of the argument following argv[i] in out_value
+/// and advances i past it. Returns false if there is no following
+/// argument or the following argument is not a number >= minimum.
+static bool parseNumberArgument(
+    int argc, char *argv[], int &i, long minimum, long &out_value)
+{
+    if(i + 1 >= argc)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    char *end = nullptr;
+    out_value = strtol(argv[i + 1], &end, 10);
+    i += 1;
+
+    return '\0' == *end && end != argv[i] && out_value >= minimum;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Stores the value of the argument following argv[i] in out_value
+/// and advances i past it. Returns false if there is no following
+/// argument or the following argument is not a probability 0..1.
+static bool parseProbabilityArgument(
+    int argc, char *argv[], int &i, double &out_value)
+{
+    if(i + 1 >= argc)
+    {   // !!!! EARLY EXIT !!!!
+        return false;
+    }
+
+    char *end = nullptr;
+    out_value = strtod(argv[i + 1], &end);
+    i += 1;
+
+    return '\0' == *end && end != argv[i] &&
+        0.0 <= out_value && out_value <= 1.0;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Prints the events recorded in the event log at path to stdout as
+/// comma separated values with one row per event. Returns the
+/// program's exit status.
+static int printEventLog(const char *path)
+{
+    EventLog::reader in(path);
+    if(!in.isValid())
+    {   // !!!! EARLY EXIT !!!!
+        fprintf(stderr, "unable to read event log %s\n", path);
+        return 1;
+    }
+
+    printf("step,event,worm,other_worm,x,y,value\n");
+    EventLog::event e;
+    while(in.next(e))
+    {
+        printf("%llu,%s,%llu,%llu,%d,%d,%d\n", (unsigned long long)e.step,
+            EventLog::getEventTypeName(e.type),
+            (unsigned long long)e.wormId, (unsigned long long)e.otherWormId,
+            e.x, e.y, e.value);
+    }
+
+    if(!in.isAtEnd())
+    {   // !!!! EARLY EXIT !!!!
+        fprintf(stderr, "event log %s is malformed\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+/// Runs numRuns simulations in parallel with seeds seed, seed+1, ...
+/// and the sets of species in speciesSets in turn, or the default
+/// species if there are none, and prints a table of results to stdout
+/// and a summary to stderr. Returns the program's exit status.
+static int runBatch(int width, int height, int numWorms, long numSteps,
+    std::uint64_t seed, double carrotRegrowthRate, bool stopsAtExtinction,
+    long numRuns, int numThreads,
+    const std::vector<SpeciesRegistry> &speciesSets)
+{
+    std::vector<SimulationBatch::configuration> configs;
+    for(long i = 0; i < numRuns; ++i)
+    {
+        const SpeciesRegistry *species = speciesSets.empty() ? nullptr :
+            &speciesSets[(std::size_t)i % speciesSets.size()];
+        SimulationBatch::configuration config = {
+            width, height, numWorms, numSteps, seed + (std::uint64_t)i,
+            stopsAtExtinction, carrotRegrowthRate, species};
+        configs.push_back(config);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<SimulationBatch::result> results(
+        SimulationBatch::run(configs, numThreads));
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    SimulationBatch::writeResultTable(stdout, results);
+
+    double sumOfRunSeconds = 0.0;
+    for(const SimulationBatch::result &r : results)
+    {
+        sumOfRunSeconds += r.seconds;
+    }
+    const double seconds = std::max(elapsed.count(), 1e-9);
+    fprintf(stderr, "%ld runs in %.6f seconds: %.1f runs/sec, "
+        "%.2fx speedup over sequential run time\n",
+        numRuns, seconds, numRuns / seconds, sumOfRunSeconds / seconds);
+
+    return 0;
+}
+
+
+int main(int argc, char * argv[])
+{
+    long width = 80;
+    long height = 24;
+    long numWorms = 6;
+    long numSteps = 1000;
+    long seed = std::random_device{}();
+    long numRuns = 1;
+    long numThreads = 0;
+    long numStepThreads = 0;
+    double carrotRegrowthRate = 0.0;
+    const char *profilePath = nullptr;
+    const char *loadSnapshotPath = nullptr;
+    const char *saveSnapshotPath = nullptr;
+    const char *eventLogPath = nullptr;
+    const char *printEventLogPath = nullptr;
+    const char *recordingPath = nullptr;
+    const char *statisticsPath = nullptr;
+    long numStepsPerProfileRow = 100;
+    long numStatisticsSamples = 0;
+    bool stopsAtExtinction = false;
+    bool isCountingAllocations = false;
+    std::vector<SpeciesRegistry> speciesSets;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        bool isValid = false;
+        if(0 == strcmp("--width", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1, width);
+        }
+        else if(0 == strcmp("--height", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1, height);
+        }
+        else if(0 == strcmp("--worms", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 0, numWorms);
+        }
+        else if(0 == strcmp("--steps", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1, numSteps);
+        }
+        else if(0 == strcmp("--seed", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 0, seed);
+        }
+        else if(0 == strcmp("--runs", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1, numRuns);
+        }
+        else if(0 == strcmp("--threads", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 0, numThreads);
+        }
+        else if(0 == strcmp("--step-threads", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 0, numStepThreads);
+        }
+        else if(0 == strcmp("--carrot-regrowth", argv[i]))
+        {
+            isValid = parseProbabilityArgument(argc, argv, i,
+                carrotRegrowthRate);
+        }
+        else if(0 == strcmp("--load-snapshot", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { loadSnapshotPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--save-snapshot", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { saveSnapshotPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--event-log", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { eventLogPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--print-event-log", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { printEventLogPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--record", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { recordingPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--species", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            int errorLine = 0;
+            if(isValid)
+            {
+                speciesSets.push_back(SpeciesRegistry(argv[++i]));
+                if(!speciesSets.back().loadFromFile(argv[i], errorLine))
+                {   // !!!! EARLY EXIT !!!!
+                    fprintf(stderr, "unable to read species %s line %d\n",
+                        argv[i], errorLine);
+                    return 1;
+                }
+            }
+        }
+        else if(0 == strcmp("--profile-csv", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { profilePath = argv[++i]; }
+        }
+        else if(0 == strcmp("--profile-every", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1,
+                numStepsPerProfileRow);
+        }
+        else if(0 == strcmp("--stats-csv", argv[i]))
+        {
+            isValid = i + 1 < argc;
+            if(isValid) { statisticsPath = argv[++i]; }
+        }
+        else if(0 == strcmp("--stats-history", argv[i]))
+        {
+            isValid = parseNumberArgument(argc, argv, i, 1,
+                numStatisticsSamples);
+        }
+        else if(0 == strcmp("--stop-at-extinction", argv[i]))
+        {
+            stopsAtExtinction = true;
+            isValid = true;
+        }
+        else if(0 == strcmp("--count-allocations", argv[i]))
+        {
+            isCountingAllocations = true;
+            isValid = true;
+        }
+
+        if(!isValid)
+        {   // !!!! EARLY EXIT !!!!
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(nullptr != printEventLogPath)
+    {   // !!!! EARLY EXIT !!!!
+        return printEventLog(printEventLogPath);
+    }
+
+    if(1 < numRuns)
+    {   // !!!! EARLY EXIT !!!!
+        return runBatch((int)width, (int)height, (int)numWorms, numSteps,
+            (std::uint64_t)seed, carrotRegrowthRate, stopsAtExtinction,
+            numRuns, (int)numThreads, speciesSets);
+    }
+
+    WormsSim sim((int)width, (int)height, speciesSets.empty() ?
+        SpeciesRegistry::getDefault() : speciesSets.front());
+    sim.seedRandomNumbers((std::uint64_t)seed);
+    sim.setCarrotRegrowthRate(carrotRegrowthRate);
+    if(nullptr != loadSnapshotPath)
+    {
+        const auto loadStart = std::chrono::steady_clock::now();
+        if(!sim.loadSnapshot(loadSnapshotPath))
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to load snapshot %s\n", loadSnapshotPath);
+            return 1;
+        }
+        const std::chrono::duration<double> loadElapsed =
+            std::chrono::steady_clock::now() - loadStart;
+        printf("loaded snapshot %s in %.3f ms\n", loadSnapshotPath,
+            1000.0 * loadElapsed.count());
+        numWorms = sim.getPopulation().getNumLiving();
+    }
+    HeadlessWormsSimUIStrategy uiStrategy(sim, numSteps, stopsAtExtinction);
+    
+    std::unique_ptr<WorkStealingThreadPool> steppingPool;
+    if(0 < numStepThreads)
+    {
+        steppingPool.reset(new WorkStealingThreadPool((int)numStepThreads));
+        sim.setSteppingThreadPool(steppingPool.get());
+    }
+
+    std::FILE *profileFile = nullptr;
+    if(nullptr != profilePath)
+    {
+        profileFile = std::fopen(profilePath, "w");
+        if(nullptr == profileFile)
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", profilePath);
+            return 1;
+        }
+        sim.getProfiler().setStepsPerInterval((int)numStepsPerProfileRow);
+        sim.getProfiler().setCsvOutput(profileFile);
+        sim.getProfiler().setEnabled(true);
+    }
+
+    std::FILE *statisticsFile = nullptr;
+    if(nullptr != statisticsPath)
+    {
+        statisticsFile = std::fopen(statisticsPath, "w");
+        if(nullptr == statisticsFile)
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", statisticsPath);
+            return 1;
+        }
+        StatisticsCollector &statistics(sim.getStatistics());
+        if(0 < numStatisticsSamples)
+        {
+            statistics.setCapacity(
+                (int)std::min(numStatisticsSamples, 0x7fffffffL));
+        }
+        statistics.setCsvOutput(statisticsFile);
+        statistics.setEnabled(true);
+    }
+
+    EventLog eventLog;
+    if(nullptr != eventLogPath)
+    {
+        if(!eventLog.open(eventLogPath, sim.getWidth(), sim.getHeight()))
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", eventLogPath);
+            return 1;
+        }
+        sim.setEventLog(&eventLog);
+    }
+
+    Recording::writer recording;
+    if(nullptr != recordingPath)
+    {
+        if(!recording.open(recordingPath, sim.getWidth(), sim.getHeight(),
+            sim.getSpecies().size(),
+            Recording::defaultKeyframeInterval))
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", recordingPath);
+            return 1;
+        }
+        sim.setRecording(&recording);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    if(nullptr != loadSnapshotPath)
+    {
+        sim.continueSimulation(uiStrategy);
+    }
+    else
+    {
+        sim.runSimulation(uiStrategy, (int)numWorms);
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    const long numHeapAllocations = HeapAllocationCounter::getCount();
+
+    if(nullptr != eventLogPath)
+    {
+        sim.setEventLog(nullptr);
+        if(!eventLog.close())
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", eventLogPath);
+            return 1;
+        }
+        printf("%lld events in %lld bytes (%.2f bytes/event) written to %s\n",
+            eventLog.getNumEvents(), eventLog.getNumBytes(),
+            (double)eventLog.getNumBytes() / std::max(eventLog.getNumEvents(), 1LL),
+            eventLogPath);
+    }
+
+    if(nullptr != recordingPath)
+    {
+        sim.setRecording(nullptr);
+        const long numFrames = recording.getNumFrames();
+        if(!recording.close())
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to write %s\n", recordingPath);
+            return 1;
+        }
+        printf("%ld frames in %lld bytes (%.1f bytes/frame) recorded in %s\n",
+            numFrames, recording.getNumBytes(),
+            (double)recording.getNumBytes() / std::max(numFrames, 1L),
+            recordingPath);
+    }
+
+    if(nullptr != saveSnapshotPath)
+    {
+        const auto saveStart = std::chrono::steady_clock::now();
+        if(!sim.saveSnapshot(saveSnapshotPath))
+        {   // !!!! EARLY EXIT !!!!
+            fprintf(stderr, "unable to save snapshot %s\n", saveSnapshotPath);
+            return 1;
+        }
+        const std::chrono::duration<double> saveElapsed =
+            std::chrono::steady_clock::now() - saveStart;
+        printf("saved snapshot %s in %.3f ms\n", saveSnapshotPath,
+            1000.0 * saveElapsed.count());
+    }
+
+    const double seconds = std::max(elapsed.count(), 1e-9);
+    if(nullptr == loadSnapshotPath)
+    {
+        printf("board %dx%d, %ld initial worms, seed %lu\n",
+            sim.getWidth(), sim.getHeight(), numWorms, (unsigned long)seed);
+    }
+    else
+    {   // The saved generator state, not seed, determines the run
+        printf("board %dx%d, %ld initial worms, continued from %s\n",
+            sim.getWidth(), sim.getHeight(), numWorms, loadSnapshotPath);
+    }
+    for(int i = 0; i < sim.getSpecies().size(); ++i)
+    {
+        printf("%d %ss, ", sim.getPopulation().getCount(i),
+            sim.getSpecies()[i].getName().c_str());
+    }
+    printf("%d hi-water-mark\n", sim.getHighWaterMark());
+    printf("%ld carrots, %g carrot regrowth rate\n",
+        sim.getNumCarrots(), sim.getCarrotRegrowthRate());
+    printf("board checksum %016llx\n",
+        (unsigned long long)sim.computeBoardChecksum());
+    if(0 <= uiStrategy.getExtinctionStep())
+    {
+        printf("all worms died by step %ld\n", uiStrategy.getExtinctionStep());
+    }
+    printf("%ld steps in %.6f seconds: %.1f steps/sec, "
+        "%.1f worm-steps/sec\n",
+        uiStrategy.getNumberOfSteps(), seconds,
+        uiStrategy.getNumberOfSteps() / seconds,
+        uiStrategy.getNumberOfWormSteps() / seconds);
+
+    if(nullptr != profileFile)
+    {
+        StepProfiler &profiler(sim.getProfiler());
+        profiler.finishInterval();
+        profiler.setCsvOutput(nullptr);
+        std::fclose(profileFile);
+
+        const StepProfiler::interval &total(profiler.getTotal());
+        printf("ms/step:");
+        for(int p = 0; p < StepProfiler::NUM_PHASES; ++p)
+        {
+            printf(" %s %.4f", StepProfiler::getPhaseName(
+                (StepProfiler::phase)p), 1000.0 * total.phaseSeconds[p] /
+                std::max(total.numSteps, 1L));
+        }
+        printf("\n%ld victim lookups, %ld carrots eaten\n",
+            total.numVictimLookups, total.numCarrotsEaten);
+    }
+
+    if(nullptr != statisticsFile)
+    {
+        sim.getStatistics().setCsvOutput(nullptr);
+        std::fclose(statisticsFile);
+        printf("%d samples of statistics written to %s\n",
+            sim.getStatistics().getNumSamples(), statisticsPath);
+    }
+
+    if(isCountingAllocations)
+    {
+        const SegmentPool::statistics &segmentStatistics(
+            sim.getWorms().getSegmentPool().getStatistics());
+        printf("segment pool: %ld blocks allocated, %ld reused, "
+            "%ld released, %ld storage reallocations\n",
+            segmentStatistics.numAllocations, segmentStatistics.numReuses,
+            segmentStatistics.numReleases,
+            sim.getWorms().getNumStorageReallocations());
+        
+        const long numAtHalfway = uiStrategy.getNumHeapAllocationsAtHalfway();
+        if(0 <= numAtHalfway)
+        {
+            printf("%ld heap allocations during the last %ld steps\n",
+                numHeapAllocations - numAtHalfway,
+                uiStrategy.getNumberOfSteps() - numSteps / 2);
+        }
+        else
+        {
+            printf("heap allocations not counted: fewer than 2 steps ran\n");
+        }
+    }
+
+    return 0;
+}
+
+/* -eof- */